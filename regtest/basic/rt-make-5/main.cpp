@@ -0,0 +1,47 @@
+#include "plumed/tools/Arena.h"
+#include "plumed/tools/OFile.h"
+#include "plumed/tools/Vector.h"
+
+using namespace PLMD;
+
+// one step: a few temporaries released in reverse order,
+// plus an array that does not fit in the first chunk if large is true
+void step(OFile& out,bool large){
+  ArenaVector<double>::type a(1000,1.0);
+  ArenaVector<Vector>::type b(100,Vector(1.0,2.0,3.0));
+  double sum=0.0;
+  for(unsigned i=0;i<a.size();i++) sum+=a[i];
+  for(unsigned i=0;i<b.size();i++) sum+=b[i][2];
+  if(large){
+    ArenaVector<double>::type c(20000,0.5);
+    for(unsigned i=0;i<c.size();i++) sum+=c[i];
+  }
+  out.printf("sum %f\n",sum);
+}
+
+int main(){
+  OFile out; out.open("output");
+  Arena& arena(Arena::get());
+
+// a block released last is reused immediately
+  void* p=arena.allocate(100);
+  arena.deallocate(p,100);
+  void* q=arena.allocate(40);
+  out.printf("reused %d\n",int(p==q));
+  arena.deallocate(q,40);
+
+  step(out,false);
+  out.printf("allocations %lu heap %lu capacity %lu\n",arena.getNumberOfAllocations(),arena.getNumberOfHeapAllocations(),(unsigned long)arena.getCapacity());
+  arena.reset();
+  step(out,true);
+  out.printf("allocations %lu heap %lu capacity %lu\n",arena.getNumberOfAllocations(),arena.getNumberOfHeapAllocations(),(unsigned long)arena.getCapacity());
+// chunks are merged, so that the next steps do not need the heap
+  arena.reset();
+  for(unsigned i=0;i<3;i++){
+    step(out,true);
+    arena.reset();
+  }
+  out.printf("allocations %lu heap %lu capacity %lu\n",arena.getNumberOfAllocations(),arena.getNumberOfHeapAllocations(),(unsigned long)arena.getCapacity());
+  out.close();
+  return 0;
+}
@@ -77,10 +77,12 @@ void Analysis::registerKeywords( Keywords& keys ){
   keys.add("hidden","REUSE_DATA_FROM","eventually this will allow you to analyse the same set of data multiple times");
   keys.add("hidden","IGNORE_REWEIGHTING","this allows you to ignore any reweighting factors");
   keys.reserveFlag("NOMEMORY",false,"analyse each block of data separately");
+  keys.reserve("optional","SPILL_FILE","store the collected data in a memory mapped file with this name rather than in memory. "
+                                       "This is useful when analysing very long trajectories.");
   ActionWithVessel::registerKeywords( keys ); keys.remove("TOL"); 
 }
 
-Analysis::Analysis(const ActionOptions&ao):
+Analysis::Analysis(const ActionOptions&ao, const bool& columns_allowed):
 Action(ao),
 ActionPilot(ao),
 ActionAtomistic(ao),
@@ -93,6 +95,8 @@ reusing_data(false),
 ignore_reweight(false),
 needeng(false),
 idata(0),
+packed(false),
+checkpoint_frame(NULL),
 firstAnalysisDone(false),
 old_norm(0.0),
 ofmt("%f"),
@@ -119,6 +123,19 @@ argument_names(getNumberOfArguments())
   if( hasatoms && hasargs ) error("currently dependencies break if you have both arguments and atoms");
   // And delte the fake reference we created
   delete checkref;
+  // Actions that only access the data through getDataPoint, getArgumentColumn and getStoredFrame
+  // store the arguments and the log weights in contiguous columns rather than in reference configurations.
+  if( columns_allowed && hasargs && !hasatoms ){
+      packed=true; columns.setNumberOfColumns( getNumberOfArguments()+1 );
+      current_row.resize( getNumberOfArguments()+1 );
+      checkpoint_frame=metricRegister().create<ReferenceConfiguration>( metricname );
+      checkpoint_frame->setNamesAndAtomNumbers( atom_numbers, argument_names );
+      frame_copies.resize(2);
+      for(unsigned i=0;i<frame_copies.size();++i){
+         frame_copies[i]=metricRegister().create<ReferenceConfiguration>( metricname );
+         frame_copies[i]->setNamesAndAtomNumbers( atom_numbers, argument_names );
+      }
+  }
 
   std::string prev_analysis; parse("REUSE_DATA_FROM",prev_analysis);
   if( prev_analysis.length()>0 ){
@@ -165,18 +182,32 @@ argument_names(getNumberOfArguments())
          if(simtemp==0) error("The MD engine does not pass the temperature to plumed so you have to specify it using TEMP");
       }
 
+      if( keywords.exists("SPILL_FILE") ){
+         std::string spillfile; parse("SPILL_FILE",spillfile);
+         if( spillfile.length()>0 ){
+            if( !packed ) error("SPILL_FILE can only be used when analysing arguments");
+            if( comm.Get_size()>1 ){ std::string rank; Tools::convert( comm.Get_rank(), rank ); spillfile += "." + rank; }
+            columns.setBackingFile( spillfile );
+            log.printf("  storing data in memory mapped file %s\n",spillfile.c_str() );
+         }
+      }
+
       parseFlag("USE_ALL_DATA",single_run); 
       if( !single_run ){
           parse("RUN",freq );
           log.printf("  running analysis every %u steps\n",freq);
           if( freq%getStride()!= 0 ) error("Frequncy of running is not a multiple of the stride");
           ndata=freq/getStride();
-          data.resize( ndata );
-          for(unsigned i=0;i<ndata;++i){ 
-             data[i]=metricRegister().create<ReferenceConfiguration>( metricname ); 
-             data[i]->setNamesAndAtomNumbers( atom_numbers, argument_names );
+          if( packed ){
+             columns.resize( ndata );
+          } else {
+             data.resize( ndata ); logweights.resize( ndata );
+             for(unsigned i=0;i<ndata;++i){ 
+                data[i]=metricRegister().create<ReferenceConfiguration>( metricname ); 
+                data[i]->setNamesAndAtomNumbers( atom_numbers, argument_names );
+             }
           }
-          logweights.resize( ndata );
+          weights.resize( ndata );
       } else {       
           log.printf("  analyzing all data in trajectory\n");
       }
@@ -219,14 +250,22 @@ void Analysis::readDataFromFile( const std::string& filename ){
         PDB mypdb;
         do_read=mypdb.readFromFilepointer(fp,plumed.getAtoms().usingNaturalUnits(),0.1/atoms.getUnits().getLength());
         if(do_read){
-           data[idata]->set( mypdb );
-           data[idata]->parse("TIME",tstep);
+           ReferenceConfiguration* myframe=( packed ? checkpoint_frame : data[idata] );
+           myframe->set( mypdb );
+           myframe->parse("TIME",tstep);
            if( !first && ((tstep-oldtstep) - getStride()*plumed.getAtoms().getTimeStep())>plumed.getAtoms().getTimeStep() ){
               error("frequency of data storage in " + filename + " is not equal to frequency of data storage plumed.dat file");
            }
-           data[idata]->parse("LOG_WEIGHT",logweights[idata]);
-           data[idata]->parse("OLD_NORM",old_norm);
-           data[idata]->checkRead();
+           double ww; myframe->parse("LOG_WEIGHT",ww);
+           myframe->parse("OLD_NORM",old_norm);
+           myframe->checkRead();
+           if( packed ){
+              for(unsigned i=0;i<getNumberOfArguments();++i) current_row[i]=myframe->getReferenceArgument(i);
+              current_row[getNumberOfArguments()]=ww;
+              columns.setRow( idata, current_row );
+           } else {
+              logweights[idata]=ww;
+           }
            idata++; first=false; oldtstep=tstep;
         } else{
            break; 
@@ -260,7 +299,7 @@ void Analysis::accumulate(){
   // Don't store the first step (also don't store if we are getting data from elsewhere)
   if( (!single_run && getStep()==0) || reusing_data ) return;
   // This is used when we have a full quota of data from the first run
-  if( !single_run && idata==logweights.size() ) return; 
+  if( !single_run && idata==getNumberOfStoredPoints() ) return; 
 
   // Retrieve the bias
   double bias=0.0; for(unsigned i=0;i<biases.size();++i) bias+=biases[i]->get();
@@ -277,12 +316,33 @@ void Analysis::accumulate(){
   // Get the arguments ready to transfer to reference configuration
   for(unsigned i=0;i<getNumberOfArguments();++i) current_args[i]=getArgument(i);
 
-  if(single_run){
+  // When all the data is used the point may be discarded or overwrite a point that is already stored
+  if( single_run ){
+     unsigned row;
+     if( !selectStorageRow( ww, row ) ) return;
+     if( row<getNumberOfStoredPoints() ){
+        if( packed ){
+           for(unsigned i=0;i<getNumberOfArguments();++i) current_row[i]=current_args[i];
+           current_row[getNumberOfArguments()]=ww; columns.setRow( row, current_row );
+        } else {
+           data[row]->setReferenceConfig( getPositions(), current_args, getMetric() ); logweights[row]=ww;
+        }
+        return;
+     }
+     plumed_dbg_assert( row==idata );
+  }
+
+  if( packed ){
+     for(unsigned i=0;i<getNumberOfArguments();++i) current_row[i]=current_args[i];
+     current_row[getNumberOfArguments()]=ww;
+     if( single_run ){ columns.push_back( current_row ); weights.push_back(0.0); }
+     else columns.setRow( idata, current_row );
+  } else if(single_run){
      data.push_back( metricRegister().create<ReferenceConfiguration>( metricname ) );
      plumed_dbg_assert( data.size()==idata+1 );
      data[idata]->setNamesAndAtomNumbers( getAbsoluteIndexes(), argument_names );
      data[idata]->setReferenceConfig( getPositions(), current_args, getMetric() );
-     logweights.push_back(ww);
+     logweights.push_back(ww); weights.push_back(0.0);
   } else {
      // Get the arguments and store them in a vector of vectors
      data[idata]->setReferenceConfig( getPositions(), current_args, getMetric() );
@@ -292,15 +352,26 @@ void Analysis::accumulate(){
   // Write data to checkpoint file
   if( write_chq ){
      rfile.rewind();
-     data[idata]->print( rfile, getTime(), logweights[idata], old_norm );
+     if( packed ){
+        checkpoint_frame->setReferenceConfig( getPositions(), current_args, getMetric() );
+        checkpoint_frame->print( rfile, getTime(), ww, old_norm );
+     } else {
+        data[idata]->print( rfile, getTime(), ww, old_norm );
+     }
      rfile.flush();
   }
   // Increment data counter
   idata++;
 }
 
+bool Analysis::selectStorageRow( const double& logweight, unsigned& row ){
+  row=getNumberOfStoredPoints(); return true;
+}
+
 Analysis::~Analysis(){
   for(unsigned i=0;i<data.size();++i ) delete data[i];
+  delete checkpoint_frame;
+  for(unsigned i=0;i<frame_copies.size();++i) delete frame_copies[i];
   if( write_chq ) rfile.close();
 }
 
@@ -315,8 +386,8 @@ std::vector<double> Analysis::getMetric() const {
 
 double Analysis::getWeight( const unsigned& idata ) const {
   if( !reusing_data ){
-     plumed_dbg_assert( idata<data.size() );
-     return data[idata]->getWeight();
+     plumed_dbg_assert( idata<weights.size() );
+     return weights[idata];
   } else {
      return mydatastash->getWeight(idata);
   }
@@ -324,54 +395,81 @@ double Analysis::getWeight( const unsigned& idata ) const {
 
 void Analysis::finalizeWeights( const bool& ignore_weights ){
   // Check that we have the correct ammount of data
-  if( !reusing_data && idata!=logweights.size() ) error("something has gone wrong.  Am trying to run analysis but I don't have sufficient data");
+  if( !reusing_data && idata!=getNumberOfStoredPoints() ) error("something has gone wrong.  Am trying to run analysis but I don't have sufficient data");
 
   norm=0;  // Reset normalization constant
   if( ignore_weights ){
-      for(unsigned i=0;i<logweights.size();++i){
-          data[i]->setWeight(1.0); norm+=1.0;
+      for(unsigned i=0;i<getNumberOfStoredPoints();++i){
+          weights[i]=1.0; norm+=1.0;
       } 
   } else if( nomemory ){
       // Find the maximum weight
-      double maxweight=logweights[0];
+      double maxweight=getLogWeight(0);
       for(unsigned i=1;i<getNumberOfDataPoints();++i){
-         if(logweights[i]>maxweight) maxweight=logweights[i];
+         if(getLogWeight(i)>maxweight) maxweight=getLogWeight(i);
       }
       // Calculate normalization constant
-      for(unsigned i=0;i<logweights.size();++i){
-         norm+=exp( logweights[i]-maxweight );
+      for(unsigned i=0;i<getNumberOfStoredPoints();++i){
+         norm+=exp( getLogWeight(i)-maxweight );
       }
       // Calculate weights (no memory)
-      for(unsigned i=0;i<logweights.size();++i){
-          data[i]->setWeight( exp( logweights[i]-maxweight ) );
+      for(unsigned i=0;i<getNumberOfStoredPoints();++i){
+          weights[i]=exp( getLogWeight(i)-maxweight );
       }
   // Calculate normalized weights (with memory)
   } else {
       // Calculate normalization constant
-      for(unsigned i=0;i<logweights.size();++i){
-         norm+=exp( logweights[i] );
+      for(unsigned i=0;i<getNumberOfStoredPoints();++i){
+         norm+=exp( getLogWeight(i) );
       }
       if( !firstAnalysisDone ) old_norm=1.0;
       // Calculate weights (with memory)
-      for(unsigned i=0;i<logweights.size();++i){
-          data[i]->setWeight( exp( logweights[i] ) / old_norm );
+      for(unsigned i=0;i<getNumberOfStoredPoints();++i){
+          weights[i]=exp( getLogWeight(i) ) / old_norm;
       }
       if( !firstAnalysisDone ) old_norm=0.0;
   }
+  // Reference configurations carry their own weight
+  for(unsigned i=0;i<data.size();++i) data[i]->setWeight( weights[i] );
   
 }
 
 void Analysis::getDataPoint( const unsigned& idata, std::vector<double>& point, double& weight ) const {
   plumed_dbg_assert( getNumberOfAtoms()==0 );
   if( !reusing_data ){
-      plumed_dbg_assert( idata<logweights.size() &&  point.size()==getNumberOfArguments() );
-      for(unsigned i=0;i<point.size();++i) point[i]=data[idata]->getReferenceArgument(i);
-      weight=data[idata]->getWeight();
+      plumed_dbg_assert( idata<getNumberOfStoredPoints() &&  point.size()==getNumberOfArguments() );
+      if( packed ){
+         for(unsigned i=0;i<point.size();++i) point[i]=columns.get(idata,i);
+      } else {
+         for(unsigned i=0;i<point.size();++i) point[i]=data[idata]->getReferenceArgument(i);
+      }
+      weight=weights[idata];
   } else {
       return mydatastash->getDataPoint( idata, point, weight );
   }
 }
 
+const double* Analysis::getArgumentColumn( const unsigned& iarg ) const {
+  if( !reusing_data ){
+      plumed_massert( packed, "data is only stored in columns for actions that allow it and use arguments only" );
+      plumed_dbg_assert( iarg<columns.getNumberOfColumns() );
+      return columns.getColumn( iarg );
+  } else {
+      return mydatastash->getArgumentColumn( iarg );
+  }
+}
+
+ReferenceConfiguration* Analysis::getStoredFrame( const unsigned& idata, const unsigned& slot ){
+  if( reusing_data ) return mydatastash->getStoredFrame( idata, slot );
+  if( !packed ) return data[idata];
+  plumed_dbg_assert( idata<getNumberOfStoredPoints() && slot<frame_copies.size() );
+  for(unsigned i=0;i<getNumberOfArguments();++i) current_args[i]=columns.get(idata,i);
+  std::vector<Vector> nopos;
+  frame_copies[slot]->setReferenceConfig( nopos, current_args, getMetric() );
+  frame_copies[slot]->setWeight( weights[idata] );
+  return frame_copies[slot];
+}
+
 void Analysis::runAnalysis(){
 
   // Note : could add multiple walkers here - simply read in the data from all
@@ -404,7 +502,7 @@ void Analysis::update(){
   accumulate();
   if( !single_run ){
     if( getStep()>0 && getStep()%freq==0 ) runAnalysis(); 
-    else if( idata==logweights.size() ) error("something has gone wrong. Probably a wrong initial time on restart"); 
+    else if( idata==getNumberOfStoredPoints() ) error("something has gone wrong. Probably a wrong initial time on restart"); 
   }
 }
 
@@ -26,6 +26,7 @@
 #include "core/ActionAtomistic.h"
 #include "core/ActionWithArguments.h"
 #include "vesselbase/ActionWithVessel.h"
+#include "ColumnStore.h"
 
 #define PLUMED_ANALYSIS_INIT(ao) Action(ao),Analysis(ao)
 
@@ -75,8 +76,22 @@ private:
   std::vector<Value*> biases;
 /// The piece of data we are inserting
   unsigned idata;
-/// The weights of all the data points
+/// The log weights of all the data points (when data is stored in columns these are in the last column)
   std::vector<double> logweights;
+/// The normalized weights of the data points
+  std::vector<double> weights;
+/// Are we storing the arguments in columns rather than as reference configurations
+  bool packed;
+/// The columns of argument values and log weights when we are storing data in columns
+  ColumnStore columns;
+/// A configuration used to read and write the checkpoint file when data is stored in columns
+  ReferenceConfiguration* checkpoint_frame;
+/// Configurations into which frames stored in columns are copied by getStoredFrame
+  std::vector<ReferenceConfiguration*> frame_copies;
+/// A row of the column store (the arguments followed by the log weight)
+  std::vector<double> current_row;
+/// The data we are going to analyze (this is empty if the arguments are stored in columns)
+  std::vector<ReferenceConfiguration*> data;
 /// Have we analyzed the data for the first time
   bool firstAnalysisDone;
 /// The value of the old normalization constant
@@ -100,13 +115,17 @@ private:
   double retrieveNorm() const ;
 /// Get the metric if we are using malonobius distance and flexible hill
   std::vector<double> getMetric() const ;
+/// Get the number of data points stored by this action
+  unsigned getNumberOfStoredPoints() const ;
+/// Get the log weight of the ith stored data point
+  double getLogWeight( const unsigned& idata ) const ;
+/// Set the log weight of the ith stored data point
+  void setLogWeight( const unsigned& idata, const double& ww );
 protected:
 /// This is used to read in output file names for analysis methods.  When
 /// this method is used and the calculation is not restarted old analysis
 /// files are backed up.
   void parseOutputFile( const std::string& key, std::string& filename );
-/// The data we are going to analyze
-  std::vector<ReferenceConfiguration*> data;
 /// Get the name of the metric we are using to measure distances
   std::string getMetricName() const ;
 /// Return the number of arguments (this overwrites the one in ActionWithArguments)
@@ -117,6 +136,13 @@ protected:
   double getWeight( const unsigned& idata ) const ;
 /// Retrieve the ith point
   void getDataPoint( const unsigned& idata, std::vector<double>& point, double& weight ) const ;
+/// Get the values the ith argument took in all the stored data points without copying them.
+/// This is only possible when the arguments are stored in columns
+  const double* getArgumentColumn( const unsigned& iarg ) const ;
+/// Get the ith data point as a reference configuration.  When the arguments are stored in 
+/// columns the data point is copied in one of two configurations that are selected with slot,
+/// so at most two of the pointers returned by this function can be used at the same time
+  ReferenceConfiguration* getStoredFrame( const unsigned& idata, const unsigned& slot=0 );
 /// Returns true if argument i is periodic together with the domain 
   bool getPeriodicityInformation(const unsigned& i, std::string& dmin, std::string& dmax);
 /// Return the normalization constant
@@ -125,6 +151,12 @@ protected:
   double getTemp () const;
 /// Are we analyzing each data block separately (if we are not this also returns the old normalization )
   bool usingMemory() const; 
+/// Are we storing all the data in the trajectory and analyzing it once at the end
+  bool usingAllData() const ;
+/// This is called when a new data point is gathered with USE_ALL_DATA.  It returns false if the point should be 
+/// discarded.  Otherwise the point is stored in row, which is either the number of stored points for a new row or
+/// the index of a stored point that is overwritten.  By default all points are kept.
+  virtual bool selectStorageRow( const double& logweight, unsigned& row );
 /// Convert the stored log weights to proper weights
   void finalizeWeights( const bool& ignore_weights );
 /// Overwrite ActionWithArguments getArguments() so that we don't return
@@ -134,7 +166,10 @@ protected:
   std::string getOutputFormat() const ;
 public:
   static void registerKeywords( Keywords& keys );
-  Analysis(const ActionOptions&);
+/// Actions that only access the data through getDataPoint, getArgumentColumn and getStoredFrame
+/// should set columns to true.  Data is then stored in contiguous columns whenever 
+/// the metric only involves arguments.
+  Analysis(const ActionOptions&, const bool& columns=false);
   ~Analysis();
   void prepare();
   void calculate();
@@ -171,13 +206,31 @@ void Analysis::unlockRequests(){
 inline
 unsigned Analysis::getNumberOfDataPoints() const {
   if( !reusing_data ){
-     plumed_dbg_assert( data.size()==logweights.size() );
-     return data.size();
+     return getNumberOfStoredPoints();
   } else {
      return mydatastash->getNumberOfDataPoints();
   }
 }
 
+inline
+unsigned Analysis::getNumberOfStoredPoints() const {
+  if( packed ) return columns.getNumberOfRows();
+  plumed_dbg_assert( data.size()==logweights.size() );
+  return logweights.size();
+}
+
+inline
+double Analysis::getLogWeight( const unsigned& idata ) const {
+  if( packed ) return columns.get( idata, columns.getNumberOfColumns()-1 );
+  return logweights[idata];
+}
+
+inline
+void Analysis::setLogWeight( const unsigned& idata, const double& ww ){
+  if( packed ) columns.set( idata, columns.getNumberOfColumns()-1, ww );
+  else logweights[idata]=ww;
+}
+
 inline
 bool Analysis::usingMemory() const {
   if( !reusing_data ){
@@ -187,6 +240,11 @@ bool Analysis::usingMemory() const {
   }
 }
 
+inline
+bool Analysis::usingAllData() const {
+  return single_run;
+}
+
 inline
 unsigned Analysis::getNumberOfArguments() const {
   unsigned nargs=ActionWithArguments::getNumberOfArguments();
@@ -25,9 +25,29 @@
 
 //+PLUMEDOC INTERNAL landmarkselection
 /*
-This is currently a filler page.  
-
-Just use LANDMARKS=ALL.  More complex versions will appear in later versions.
+Landmark selection allows you to analyze a subset of the stored data.  The 
+distances between the landmarks and the remaining frames are then used to ascribe 
+Voronoi weights to the landmarks, which can be switched off using the NOVORONOI flag.  
+Reweighting of the data during selection can be switched off with IGNORE_WEIGHTS.
+The following methods are available:
+
+<table align=center frame=void width=95%% cellpadding=5%%>
+<tr> 
+<td width=5%%> ALL </td> <td> use all the stored data </td>
+</tr> <tr>
+<td> STRIDE </td> <td> select N frames evenly spaced through the stored data e.g. LANDMARKS={STRIDE N=100} </td>
+</tr> <tr>
+<td> FPS </td> <td> select N frames using farthest point sampling.  The first landmark is picked at random 
+using the seed SEED and each subsequent landmark is the frame farthest from all the landmarks chosen so far 
+e.g. LANDMARKS={FPS N=100 SEED=1234}.  Only the distance from each frame to its closest landmark is stored. </td>
+</tr> <tr>
+<td> RESERVOIR </td> <td> select N frames at random in proportion to their weights using weighted reservoir sampling, 
+which requires a single pass through the stored data and only keeps N candidate frames during the selection 
+e.g. LANDMARKS={RESERVOIR N=100 SEED=1234}.  If USE_ALL_DATA is used the STREAM flag can be given to select the landmarks 
+as the data is gathered so that only N frames are ever stored.  Voronoi weights cannot be computed in this case and
+the total weight of the data is instead shared equally between the landmarks </td>
+</tr>
+</table>
 
 */
 //+ENDPLUMEDOC
@@ -40,17 +60,19 @@ void AnalysisWithLandmarks::registerKeywords( Keywords& keys ){
   keys.add("compulsory","LANDMARKS","ALL","only use a subset of the data that was collected. "
                                           "For more information on the landmark selection algorithms that are available in "
                                           "plumed see \\ref landmarkselection.");
+  keys.use("SPILL_FILE");
 }
 
 AnalysisWithLandmarks::AnalysisWithLandmarks( const ActionOptions& ao):
 Action(ao),
-Analysis(ao),
+Analysis(ao,true),
 data_to_analyze(NULL)
 {
    std::string linput; parse("LANDMARKS",linput);
    std::vector<std::string> words=Tools::getWords(linput); 
    landmarkSelector=landmarkRegister().create( LandmarkSelectionOptions(words,this) );
    log.printf("  %s\n", landmarkSelector->description().c_str() );
+   if( landmarkSelector->selectsWhileStoring() && !usingAllData() ) error("landmarks can only be selected as the data is gathered when USE_ALL_DATA is used");
 }
 
 AnalysisWithLandmarks::~AnalysisWithLandmarks(){
@@ -65,6 +87,11 @@ unsigned AnalysisWithLandmarks::getNumberOfLandmarks() const {
   return landmarkSelector->getNumberOfLandmarks();
 }
 
+bool AnalysisWithLandmarks::selectStorageRow( const double& logweight, unsigned& row ){
+  if( !landmarkSelector->selectsWhileStoring() ) return Analysis::selectStorageRow( logweight, row );
+  return landmarkSelector->storeFrame( logweight, getNumberOfDataPoints(), row );
+}
+
 void AnalysisWithLandmarks::performAnalysis(){
   plumed_assert( data_to_analyze );
   landmarkSelector->selectLandmarks( data_to_analyze );
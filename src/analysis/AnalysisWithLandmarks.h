@@ -45,6 +45,8 @@ protected:
   void setDataToAnalyze( MultiReferenceBase* mydata );
 /// Return the number of landmarks we are selecting
   unsigned getNumberOfLandmarks() const ;
+/// Let the landmark selector discard frames as they are gathered if it can
+  bool selectStorageRow( const double& logweight, unsigned& row );
 public:
   static void registerKeywords( Keywords& keys );
   AnalysisWithLandmarks( const ActionOptions& );
@@ -21,34 +21,47 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "ClassicalScaling.h"
 #include "reference/PointWiseMapping.h"
+#include "tools/Lanczos.h"
 
 namespace PLMD {
 namespace analysis {
 
+/// The matrix -0.5*J*D*J where J is the centering matrix and D the matrix of squared distances.
+/// This is never stored: products with it are computed by centering the vector before and after
+/// multiplying it by the distance matrix
+class CenteredDistanceMatrix : public SymmetricOperator {
+private:
+  const Matrix<double>& dmat;
+  mutable std::vector<double> centered;
+public:
+  explicit CenteredDistanceMatrix( const Matrix<double>& d ) : dmat(d), centered(d.nrows()) {}
+  unsigned size() const { return dmat.nrows(); }
+  void apply( const std::vector<double>& x, std::vector<double>& y ) const ;
+};
+
+void CenteredDistanceMatrix::apply( const std::vector<double>& x, std::vector<double>& y ) const {
+  unsigned n=x.size(); double mean=0;
+  for(unsigned i=0;i<n;++i) mean+=x[i];
+  mean/=n; for(unsigned i=0;i<n;++i) centered[i]=x[i]-mean;
+  mult( dmat, centered, y );
+  mean=0; for(unsigned i=0;i<n;++i) mean+=y[i];
+  mean/=n; for(unsigned i=0;i<n;++i) y[i]=-0.5*(y[i]-mean);
+}
+
 void ClassicalScaling::run( PointWiseMapping* mymap ){
-   // Retrieve the distances from the dimensionality reduction object
-   double half=(-0.5); Matrix<double> distances( half*mymap->modifyDmat() ); 
- 
-   // Apply centering transtion
-   unsigned n=distances.nrows(); double sum;
-   // First HM
-   for(unsigned i=0;i<n;++i){
-       sum=0; for(unsigned j=0;j<n;++j) sum+=distances(i,j);
-       for(unsigned j=0;j<n;++j) distances(i,j) -= sum/n;
-   }
-   // Now (HM)H
-   for(unsigned i=0;i<n;++i){
-      sum=0; for(unsigned j=0;j<n;++j) sum+=distances(j,i);
-      for(unsigned j=0;j<n;++j) distances(j,i) -= sum/n; 
-   }
+   // Only the largest eigenvalues of the centered matrix of distances are required. These are 
+   // found iteratively so the centered matrix is never stored and there is no O(N^3) diagonalization
+   CenteredDistanceMatrix centered( mymap->modifyDmat() );
+   unsigned n=centered.size(), nlow=mymap->getNumberOfProperties();
 
    // Diagonalize matrix
-   std::vector<double> eigval(n); Matrix<double> eigvec(n,n);
-   diagMat( distances, eigval, eigvec );
+   std::vector<double> eigval(nlow); Matrix<double> eigvec(nlow,n);
+   Lanczos mysolver( centered ); 
+   if( mysolver.diagonalize( nlow, eigval, eigvec )!=0 ) plumed_merror("failed to find eigenvectors for classical scaling");
 
    // Pass final projections to map object
    for(unsigned i=0;i<n;++i){
-      for(unsigned j=0;j<mymap->getNumberOfProperties();++j) mymap->setProjectionCoordinate( i, j, sqrt(eigval[n-1-j])*eigvec(n-1-j,i) ); 
+      for(unsigned j=0;j<nlow;++j) mymap->setProjectionCoordinate( i, j, sqrt(eigval[j])*eigvec(j,i) ); 
    }
 }
 
@@ -0,0 +1,121 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "ColumnStore.h"
+#include "tools/Exception.h"
+#include <cstring>
+
+#ifdef __PLUMED_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace PLMD {
+namespace analysis {
+
+ColumnStore::ColumnStore():
+ncols(0),
+nrows(0),
+capacity(0),
+base(NULL),
+fd(-1),
+mapped(0)
+{
+}
+
+ColumnStore::~ColumnStore(){
+  unmap();
+}
+
+void ColumnStore::unmap(){
+#ifdef __PLUMED_HAS_MMAP
+  if( mapped>0 ) munmap( base, mapped );
+  if( fd>=0 ){ close(fd); unlink( filename.c_str() ); }
+#endif
+  fd=-1; mapped=0;
+}
+
+void ColumnStore::setNumberOfColumns( const unsigned& n ){
+  ncols=n; nrows=0; capacity=0; 
+  memory.resize(0); if( fd<0 ) base=NULL; 
+}
+
+void ColumnStore::setBackingFile( const std::string& fname ){
+#ifdef __PLUMED_HAS_MMAP
+  plumed_massert( nrows==0, "backing file must be set before any data is stored" );
+  unmap(); filename=fname; 
+  fd=open( filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+  if( fd<0 ) plumed_merror("could not open file " + filename + " to store data");
+  capacity=0; base=NULL;
+#else
+  plumed_merror("cannot store data in file " + fname + " as plumed was compiled without mmap");
+#endif
+}
+
+void ColumnStore::reserve( const unsigned& n ){
+  if( n<=capacity ) return;
+  unsigned newcap=( capacity>0 ? capacity : 1024 );
+  while( newcap<n ) newcap*=2;
+  size_t oldcap=capacity; 
+
+  if( fd<0 ){
+     std::vector<double> newmem( static_cast<size_t>(ncols)*newcap );
+     for(unsigned j=0;j<ncols;++j){
+        if( nrows>0 ) std::memcpy( &newmem[j*static_cast<size_t>(newcap)], &memory[j*oldcap], nrows*sizeof(double) ); 
+     }
+     memory.swap( newmem );
+     base=( memory.empty() ? NULL : &memory[0] );
+  } else {
+#ifdef __PLUMED_HAS_MMAP
+     size_t bytes=static_cast<size_t>(ncols)*newcap*sizeof(double);
+     if( bytes==0 ) bytes=sizeof(double);
+     if( ftruncate( fd, bytes )!=0 ) plumed_merror("could not grow file " + filename);
+     if( mapped>0 ) munmap( base, mapped );
+     void* ptr=mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+     if( ptr==MAP_FAILED ) plumed_merror("could not map file " + filename + " into memory");
+     base=static_cast<double*>( ptr ); mapped=bytes;
+     // Columns move further apart when the file grows so shift them starting from the last
+     for(unsigned j=ncols;j>0;--j){
+        if( nrows>0 ) std::memmove( base + (j-1)*static_cast<size_t>(newcap), base + (j-1)*oldcap, nrows*sizeof(double) );
+     }
+#endif
+  }
+  capacity=newcap;
+}
+
+void ColumnStore::resize( const unsigned& n ){
+  reserve( n ); nrows=n;
+}
+
+void ColumnStore::push_back( const std::vector<double>& row ){
+  reserve( nrows+1 ); nrows++; setRow( nrows-1, row );
+}
+
+void ColumnStore::setRow( const unsigned& i, const std::vector<double>& row ){
+  plumed_dbg_assert( i<nrows && row.size()==ncols );
+  for(unsigned j=0;j<ncols;++j) base[ static_cast<size_t>(j)*capacity + i ]=row[j];
+}
+
+}
+}
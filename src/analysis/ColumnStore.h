@@ -0,0 +1,116 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_analysis_ColumnStore_h
+#define __PLUMED_analysis_ColumnStore_h
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace PLMD {
+namespace analysis {
+
+/**
+\ingroup TOOLBOX
+Stores a set of frames of argument values as one contiguous column per argument.
+
+Column j of the store is held in a single array so it can be read without copying 
+using getColumn.  The columns can either be held in memory or in a file that is 
+mapped into memory so that very long trajectories can be analysed without
+exhausting the RAM.
+*/
+
+class ColumnStore {
+private:
+/// The number of columns
+  unsigned ncols;
+/// The number of rows that have been stored
+  unsigned nrows;
+/// The number of rows that can be stored without reallocating
+  unsigned capacity;
+/// The storage when we are holding the data in memory
+  std::vector<double> memory;
+/// The beginning of the storage 
+  double* base;
+/// The name of the file we are mapping (empty if we are using memory)
+  std::string filename;
+/// The file descriptor of the mapped file
+  int fd;
+/// The number of bytes that are currently mapped
+  size_t mapped;
+/// Make space for at least n rows
+  void reserve( const unsigned& n );
+/// Release the mapped file
+  void unmap();
+public:
+  ColumnStore();
+  ~ColumnStore();
+/// Set the number of columns (this clears the store)
+  void setNumberOfColumns( const unsigned& n );
+/// Hold the columns in a memory mapped file with the given name
+  void setBackingFile( const std::string& fname );
+/// Set the number of rows 
+  void resize( const unsigned& n );
+/// Add a row at the end of the store
+  void push_back( const std::vector<double>& row );
+/// Set the values in the ith row
+  void setRow( const unsigned& i, const std::vector<double>& row );
+/// Get the number of rows
+  unsigned getNumberOfRows() const ;
+/// Get the number of columns
+  unsigned getNumberOfColumns() const ;
+/// Get a pointer to the beginning of the jth column
+  const double* getColumn( const unsigned& j ) const ;
+/// Get the element in the ith row and jth column
+  double get( const unsigned& i, const unsigned& j ) const ;
+/// Set the element in the ith row and jth column
+  void set( const unsigned& i, const unsigned& j, const double& val );
+};
+
+inline
+unsigned ColumnStore::getNumberOfRows() const {
+  return nrows;
+}
+
+inline
+unsigned ColumnStore::getNumberOfColumns() const {
+  return ncols;
+}
+
+inline
+const double* ColumnStore::getColumn( const unsigned& j ) const {
+  return base + static_cast<size_t>(j)*capacity;
+}
+
+inline
+double ColumnStore::get( const unsigned& i, const unsigned& j ) const {
+  return base[ static_cast<size_t>(j)*capacity + i ];
+}
+
+inline
+void ColumnStore::set( const unsigned& i, const unsigned& j, const double& val ){
+  base[ static_cast<size_t>(j)*capacity + i ]=val;
+}
+
+}
+}
+#endif
@@ -0,0 +1,97 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "LandmarkSelectionBase.h"
+#include "LandmarkRegister.h"
+#include "tools/Random.h"
+#include <limits>
+
+namespace PLMD {
+namespace analysis {
+
+class FarthestPointSampling : public LandmarkSelectionBase {
+private:
+  int seed;
+public:
+  FarthestPointSampling( const LandmarkSelectionOptions& lo );
+  std::string rest_of_description();
+  void select( MultiReferenceBase* );
+};
+
+PLUMED_REGISTER_LANDMARKS(FarthestPointSampling,"FPS")
+
+FarthestPointSampling::FarthestPointSampling( const LandmarkSelectionOptions& lo ):
+LandmarkSelectionBase(lo),
+seed(1234)
+{
+  parseOptional("SEED",seed);
+}
+
+std::string FarthestPointSampling::rest_of_description(){
+  std::string sseed; Tools::convert(seed,sseed);
+  return "first landmark is chosen at random using seed " + sseed;
+}
+
+void FarthestPointSampling::select( MultiReferenceBase* myframes ){
+  unsigned nframes=getNumberOfFrames(), nland=getNumberOfLandmarks();
+  if( nland>nframes ) plumed_merror("cannot select more landmarks than there are frames of data");
+
+  Communicator& comm( getCommunicator() );
+  unsigned rank=comm.Get_rank(), size=comm.Get_size();
+
+  // Every node uses the same seed so they all agree on the first landmark
+  Random random; random.setSeed(-seed);
+  unsigned last=static_cast<unsigned>( random.RandU01()*nframes );
+  if( last>=nframes ) last=nframes-1;
+  selectFrame( last, myframes );
+
+  // Distance from each frame to the closest landmark selected so far.  Each node only
+  // stores and updates the frames it is responsible for and frames that have already been
+  // selected are flagged with a negative distance.
+  std::vector<double> mindist( nframes, -1.0 );
+  for(unsigned i=rank;i<nframes;i+=size) mindist[i]=std::numeric_limits<double>::max();
+
+  std::vector<double> maxdist( size );
+  std::vector<unsigned> maxind( size );
+  for(unsigned n=1;n<nland;++n){
+     double mymax=-1.0; unsigned myind=nframes;
+     for(unsigned i=rank;i<nframes;i+=size){
+        if( i==last ) mindist[i]=-1.0;
+        if( mindist[i]<0 ) continue;
+        double d=getDistanceBetweenFrames( i, last );
+        if( d<mindist[i] ) mindist[i]=d;
+        if( mindist[i]>mymax ){ mymax=mindist[i]; myind=i; }
+     }
+     // Find the farthest point across all the nodes
+     maxdist.assign( size, 0.0 ); maxind.assign( size, 0 );
+     maxdist[rank]=mymax; maxind[rank]=myind;
+     comm.Sum( &maxdist[0], size ); comm.Sum( &maxind[0], size );
+     unsigned best=0;
+     for(unsigned j=1;j<size;++j){
+        if( maxdist[j]>maxdist[best] || ( maxdist[j]==maxdist[best] && maxind[j]<maxind[best] ) ) best=j;
+     }
+     plumed_assert( maxdist[best]>=0 && maxind[best]<nframes );
+     last=maxind[best]; selectFrame( last, myframes );
+  }
+}
+
+}
+}
@@ -24,6 +24,7 @@
 #include "core/ActionRegister.h"
 #include "tools/Grid.h"
 #include "tools/KernelFunctions.h"
+#include "tools/BinnedKernelDensity.h"
 #include "tools/IFile.h"
 #include "tools/OFile.h"
 
@@ -40,6 +41,12 @@ continuos function on the grid with a BANDWIDTH defined by the user. In this cas
 the INTEGRAL over the grid is 1. In case a discrete density estimation is used the probabilty density is estimated
 as a discrete function on the grid. In this case the normalisation is such that the SUM of over the grid is 1.
 
+When you have a large amount of data you can use the BINNED_KDE flag.  The weights of the data points are then
+shared between the corners of the grid cells that contain them and the result is convolved with the kernel.  The
+cost of this calculation thus depends on the size of the grid rather than on the number of data points.  The
+result is a very close approximation to the exact kernel density estimate as long as the grid spacing is small 
+compared to the BANDWIDTH.  This option is only available with gaussian kernels.
+
 Additional material and examples can be also found in the tutorial \ref belfast-1. 
  
 \par Examples
@@ -120,6 +127,7 @@ private:
   std::string kerneltype;
   bool fenergy; 
   bool unnormalized;
+  bool binned;
 public:
   static void registerKeywords( Keywords& keys );
   Histogram(const ActionOptions&ao);
@@ -142,14 +150,18 @@ void Histogram::registerKeywords( Keywords& keys ){
   keys.addFlag("FREE-ENERGY",false,"Set to TRUE if you want a FREE ENERGY instead of a probabilty density (you need to set TEMP).");
   keys.addFlag("UNNORMALIZED",false,"Set to TRUE if you don't want histogram to be normalized or free energy to be shifted.");
   keys.add("compulsory","GRID_WFILE","histogram","the file on which to write the grid");
-  keys.use("NOMEMORY");
+  keys.addFlag("BINNED_KDE",false,"bin the data on the grid and then convolve with the kernel rather than adding one kernel per data point. "
+                                  "This is much faster when there is a lot of data");
+  keys.use("NOMEMORY"); keys.use("SPILL_FILE");
 }
 
 Histogram::Histogram(const ActionOptions&ao):
-PLUMED_ANALYSIS_INIT(ao),
+Action(ao),
+Analysis(ao,true),
 point(getNumberOfArguments()),
 fenergy(false),
-unnormalized(false)
+unnormalized(false),
+binned(false)
 {
   // Read stuff for Grid
   parseVector("GRID_MIN",gmin);
@@ -187,6 +199,9 @@ unnormalized(false)
   if(bw.size()!=getNumberOfArguments()&&kerneltype!="discrete") 
     error("Wrong number of values for BANDWIDTH: they should be equal to the number of arguments");
 
+  parseFlag("BINNED_KDE",binned);
+  if( binned && kerneltype!="gaussian" ) error("BINNED_KDE can only be used with gaussian kernels");
+
   parseFlag("FREE-ENERGY",fenergy);
   if(getTemp()<=0 && fenergy) error("Set the temperature (TEMP) if you want a free energy.");
 
@@ -201,6 +216,7 @@ unnormalized(false)
   checkRead();
 
   log.printf("  Using %s kernel functions\n",kerneltype.c_str() );
+  if( binned ) log.printf("  data is binned on the grid before it is convolved with the kernel\n");
   log.printf("  Grid min");
   for(unsigned i=0;i<gmin.size();++i) log.printf(" %s",gmin[i].c_str() );
   log.printf("\n");
@@ -245,7 +261,17 @@ void Histogram::performAnalysis(){
 
   // Now build the histogram
   double weight; std::vector<double> point( getNumberOfArguments() );
-  if(kerneltype!="discrete") {
+  if( binned ){
+    BinnedKernelDensity kde( *gg, bw, true );
+    std::vector<const double*> columns( getNumberOfArguments() );
+    for(unsigned j=0;j<getNumberOfArguments();++j) columns[j]=getArgumentColumn(j);
+    unsigned stride=comm.Get_size(), rank=comm.Get_rank();
+    for(unsigned i=rank;i<getNumberOfDataPoints();i+=stride){
+      for(unsigned j=0;j<point.size();++j) point[j]=columns[j][i];
+      kde.addPoint( point, getWeight(i) );
+    }
+    kde.sum( comm ); kde.addToGrid( *gg );
+  } else if(kerneltype!="discrete") {
     for(unsigned i=0;i<getNumberOfDataPoints();++i){
       getDataPoint( i, point, weight );
       KernelFunctions kernel( point, bw, kerneltype, false, weight, true);
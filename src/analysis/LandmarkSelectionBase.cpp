@@ -34,7 +34,9 @@ action(myanalysis)
 LandmarkSelectionBase::LandmarkSelectionBase( const LandmarkSelectionOptions& lo ):
 style(lo.words[0]),
 input(lo.words),
-action(lo.action)
+action(lo.action),
+novoronoi(false),
+noweights(false)
 {
   input.erase( input.begin() );
   if( style=="ALL" ){
@@ -76,12 +78,22 @@ double LandmarkSelectionBase::getWeightOfFrame( const unsigned& iframe ){
   return action->getWeight(iframe);
 }
 double LandmarkSelectionBase::getDistanceBetweenFrames( const unsigned& iframe, const unsigned& jframe  ){
-  return distance( action->getPbc(), action->getArguments(), action->data[iframe], action->data[jframe], false );
+  return distance( action->getPbc(), action->getArguments(), action->getStoredFrame(iframe,0), action->getStoredFrame(jframe,1), false );
+}
+
+bool LandmarkSelectionBase::chooseStorageRow( const double& logweight, const unsigned& nstored, unsigned& row ){
+  plumed_merror("landmark selection style " + style + " cannot select landmarks as the data is gathered");
+  return false;
+}
+
+bool LandmarkSelectionBase::storeFrame( const double& logweight, const unsigned& nstored, unsigned& row ){
+  if(noweights) return chooseStorageRow( 0.0, nstored, row );
+  return chooseStorageRow( logweight, nstored, row );
 }
 
 void LandmarkSelectionBase::selectFrame( const unsigned& iframe, MultiReferenceBase* myframes){
   plumed_assert( myframes->getNumberOfReferenceFrames()<nlandmarks );
-  myframes->copyFrame( action->data[iframe] );
+  myframes->copyFrame( action->getStoredFrame(iframe) );
 }
 
 void LandmarkSelectionBase::selectLandmarks( MultiReferenceBase* myframes ){
@@ -89,16 +101,16 @@ void LandmarkSelectionBase::selectLandmarks( MultiReferenceBase* myframes ){
   myframes->clearFrames(); select( myframes );
   plumed_assert( myframes->getNumberOfReferenceFrames()==nlandmarks );
 
-  // Now calculate voronoi weights 
-  if( !novoronoi ){
+  // Now calculate voronoi weights (this is not possible if the frames that are not landmarks have been discarded)
+  if( !novoronoi && !selectsWhileStoring() ){
       unsigned rank=action->comm.Get_rank();
       unsigned size=action->comm.Get_size();
       std::vector<double> weights( nlandmarks, 0.0 );
-      for(unsigned i=rank;i<action->data.size();i+=size){
-          unsigned closest=0;
-          double mindist=distance( action->getPbc(), action->getArguments(), action->data[i], myframes->getFrame(0), false );
+      for(unsigned i=rank;i<action->getNumberOfDataPoints();i+=size){
+          unsigned closest=0; ReferenceConfiguration* myframe=action->getStoredFrame(i);
+          double mindist=distance( action->getPbc(), action->getArguments(), myframe, myframes->getFrame(0), false );
           for(unsigned j=1;j<nlandmarks;++j){
-              double dist=distance( action->getPbc(), action->getArguments(), action->data[i], myframes->getFrame(j), false );
+              double dist=distance( action->getPbc(), action->getArguments(), myframe, myframes->getFrame(j), false );
               if( dist<mindist ){ mindist=dist; closest=j; }
           } 
           weights[closest] += getWeightOfFrame(i);
@@ -60,6 +60,9 @@ protected:
 /// Read a keywords from the input 
   template <class T>
   void parse(const std::string& ,T& );
+/// Read a keyword from the input if it is present (returns false if it was not found)
+  template <class T>
+  bool parseOptional(const std::string& ,T& );
 /// Read a flag from the input
   void parseFlag(const std::string& key, bool& t);
 /// Get the number of frames in the underlying action
@@ -70,14 +73,22 @@ protected:
   double getDistanceBetweenFrames( const unsigned& , const unsigned&  );
 /// Transfer frame i in the underlying action to the object we are going to analyze
   void selectFrame( const unsigned& , MultiReferenceBase* );
+/// Overwrite this to decide where a new frame is stored when landmarks are selected as the data is gathered
+  virtual bool chooseStorageRow( const double& logweight, const unsigned& nstored, unsigned& row );
 public:
   LandmarkSelectionBase( const LandmarkSelectionOptions& lo );
+  virtual ~LandmarkSelectionBase(){}
 /// Check everything was read in
   void checkRead() const ;
 /// Return a description of the landmark selection protocol
   std::string description();
 /// Overwrite this to have a more descriptive output
   virtual std::string rest_of_description(){ return ""; };
+/// Overwrite this to return true if the landmarks are selected as the data is gathered so only the landmarks are stored
+  virtual bool selectsWhileStoring() const { return false; }
+/// Decide whether a new frame with log weight logweight is stored and in which row when landmarks are selected as the 
+/// data is gathered (see Analysis::selectStorageRow)
+  bool storeFrame( const double& logweight, const unsigned& nstored, unsigned& row );
 /// Actually do landmark selection
   void selectLandmarks( MultiReferenceBase* );
   virtual void select( MultiReferenceBase* )=0;
@@ -104,6 +115,11 @@ void LandmarkSelectionBase::parse( const std::string& key, T& t ){
   if(!found) plumed_merror("landmark seleciton style " + style + " requires " + key + " keyword");
 }
 
+template <class T>
+bool LandmarkSelectionBase::parseOptional( const std::string& key, T& t ){
+  return Tools::parse(input,key,t);
+}
+
 }
 }
 #endif
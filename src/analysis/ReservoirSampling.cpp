@@ -0,0 +1,153 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "LandmarkSelectionBase.h"
+#include "LandmarkRegister.h"
+#include "tools/Random.h"
+#include "reference/MultiReferenceBase.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <limits>
+
+namespace PLMD {
+namespace analysis {
+
+class ReservoirSampling : public LandmarkSelectionBase {
+private:
+  int seed;
+/// Are we selecting the landmarks as the data is gathered
+  bool stream;
+/// The random number generator used when streaming
+  Random random;
+/// The keys of the stored frames and the rows they are stored in (the frame with the smallest key is on top)
+  typedef std::pair<double,unsigned> keyed_frame;
+  std::priority_queue<keyed_frame, std::vector<keyed_frame>, std::greater<keyed_frame> > reservoir;
+/// The number of frames that have been seen when streaming
+  unsigned nseen;
+/// The position in the trajectory and the log weight of the frame in each row
+  std::vector<unsigned> seen_index;
+  std::vector<double> row_logweights;
+/// The logarithm of the sum of the weights of all the frames seen
+  double logtotal;
+/// Get the key of a frame from the logarithm of its weight
+  double getKey( const double& logweight );
+/// Add log(exp(a)+exp(b)) without overflowing
+  static double logAdd( const double& a, const double& b );
+protected:
+  bool chooseStorageRow( const double& logweight, const unsigned& nstored, unsigned& row );
+public:
+  ReservoirSampling( const LandmarkSelectionOptions& lo );
+  std::string rest_of_description();
+  bool selectsWhileStoring() const { return stream; }
+  void select( MultiReferenceBase* );
+};
+
+PLUMED_REGISTER_LANDMARKS(ReservoirSampling,"RESERVOIR")
+
+ReservoirSampling::ReservoirSampling( const LandmarkSelectionOptions& lo ):
+LandmarkSelectionBase(lo),
+seed(1234),
+stream(false),
+nseen(0),
+logtotal(-std::numeric_limits<double>::max())
+{
+  parseOptional("SEED",seed);
+  parseFlag("STREAM",stream);
+  random.setSeed(-seed);
+}
+
+std::string ReservoirSampling::rest_of_description(){
+  std::string sseed; Tools::convert(seed,sseed);
+  if( stream ) return "landmarks are selected as the data is gathered using random seed " + sseed + " so only the landmarks are stored";
+  return "landmarks are drawn in a single pass through the data using random seed " + sseed;
+}
+
+double ReservoirSampling::getKey( const double& logweight ){
+  // Weighted reservoir sampling keeps the frames with the largest u^(1/w).  Taking logarithms twice gives 
+  // the same ordering with log(w)-log(-log(u)), which can be computed from the log weight without overflowing
+  double u=random.RandU01();
+  if( u>0 && logweight>-std::numeric_limits<double>::max() ) return logweight - std::log( -std::log(u) );
+  return -std::numeric_limits<double>::max();
+}
+
+double ReservoirSampling::logAdd( const double& a, const double& b ){
+  if( a<b ) return b + std::log( 1.0 + std::exp(a-b) );
+  return a + std::log( 1.0 + std::exp(b-a) );
+}
+
+bool ReservoirSampling::chooseStorageRow( const double& logweight, const unsigned& nstored, unsigned& row ){
+  unsigned nland=getNumberOfLandmarks();
+  double key=getKey( logweight ); logtotal=logAdd( logtotal, logweight ); nseen++;
+  if( nstored<nland ){
+     row=nstored; seen_index.push_back( nseen-1 ); row_logweights.push_back( logweight );
+  } else if( key>reservoir.top().first ){
+     // The new frame takes the place of the stored frame with the smallest key
+     row=reservoir.top().second; reservoir.pop();
+     seen_index[row]=nseen-1; row_logweights[row]=logweight;
+  } else {
+     return false;
+  }
+  reservoir.push( keyed_frame(key,row) );
+  return true;
+}
+
+void ReservoirSampling::select( MultiReferenceBase* myframes ){
+  unsigned nframes=getNumberOfFrames(), nland=getNumberOfLandmarks();
+  if( nland>nframes ) plumed_merror("cannot select more landmarks than there are frames of data");
+
+  if( stream ){
+     // The frames that were kept are the landmarks and they are added in the order they were seen
+     std::vector<std::pair<unsigned,unsigned> > order( nframes );
+     for(unsigned i=0;i<nframes;++i) order[i]=std::make_pair( seen_index[i], i );
+     std::sort( order.begin(), order.end() );
+     double kept=0, logkept=-std::numeric_limits<double>::max();
+     for(unsigned i=0;i<nframes;++i){
+        selectFrame( order[i].second, myframes );
+        kept+=getWeightOfFrame( order[i].second ); logkept=logAdd( logkept, row_logweights[order[i].second] );
+     }
+     // Each landmark stands for an equal share of the weight of all the frames that were seen
+     std::vector<double> weights( nland, kept*std::exp( logtotal-logkept ) / nland );
+     myframes->setWeights( weights );
+     return;
+  }
+
+  // Weighted reservoir sampling: only the reservoir is stored so memory does not grow with the number 
+  // of frames.  Every node uses the same seed so no communication is required.
+  random.setSeed(-seed);
+  for(unsigned i=0;i<nframes;++i){
+     double w=getWeightOfFrame(i), key;
+     if( w>0 ) key=getKey( std::log(w) );
+     else { random.RandU01(); key=-std::numeric_limits<double>::max(); }
+     if( reservoir.size()<nland ) reservoir.push( keyed_frame(key,i) );
+     else if( key>reservoir.top().first ){ reservoir.pop(); reservoir.push( keyed_frame(key,i) ); }
+  }
+
+  // Landmarks are stored in the order they appear in the data
+  std::vector<unsigned> landmarks; landmarks.reserve( nland );
+  while( !reservoir.empty() ){ landmarks.push_back( reservoir.top().second ); reservoir.pop(); }
+  std::sort( landmarks.begin(), landmarks.end() );
+  for(unsigned i=0;i<landmarks.size();++i) selectFrame( landmarks[i], myframes );
+}
+
+}
+}
@@ -88,6 +88,9 @@ class ABMD : public Bias{
   std::vector<double> temp;
   std::vector<int> seed;
   vector<Random> random;
+  std::vector<Value*> valueMin;
+  Value* valueBias;
+  Value* valueForce2;
 public:
   ABMD(const ActionOptions&);
   void calculate();
@@ -144,11 +147,14 @@ random(getNumberOfArguments())
   for(unsigned i=0;i<getNumberOfArguments();i++) {
      std::string str_min=getPntrToArgument(i)->getName()+"_min";
      addComponent(str_min); componentIsNotPeriodic(str_min);
-     if(min[i]!=-1.0) getPntrToComponent(str_min)->set(min[i]);
+     valueMin.push_back(getPntrToComponent(str_min));
+     if(min[i]!=-1.0) valueMin[i]->set(min[i]);
   }
   for(unsigned i=0;i<getNumberOfArguments();i++) {random[i].setSeed(-seed[i]);}
   addComponent("bias"); componentIsNotPeriodic("bias");
   addComponent("force2"); componentIsNotPeriodic("force2");
+  valueBias=getPntrToComponent("bias");
+  valueForce2=getPntrToComponent("force2");
 }
 
 
@@ -179,11 +185,10 @@ void ABMD::calculate(){
       ene += 0.5*k*(cv2-min[i])*(cv2-min[i]);
       totf2+=f*f;
     }
-    std::string str_min=getPntrToArgument(i)->getName()+"_min";
-    getPntrToComponent(str_min)->set(min[i]);
+    valueMin[i]->set(min[i]);
   }
-  getPntrToComponent("bias")->set(ene);
-  getPntrToComponent("force2")->set(totf2);
+  valueBias->set(ene);
+  valueForce2->set(totf2);
 }
 
 }
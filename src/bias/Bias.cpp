@@ -32,7 +32,6 @@ ActionWithValue(ao),
 ActionWithArguments(ao),
 outputForces(getNumberOfArguments(),0.0)
 {
-  if(getStride()>1) error("Using bias with stride!=1 is not currently supported");
   for(unsigned i=0;i<getNumberOfArguments();++i){
      (getPntrToArgument(i)->getPntrToAction())->turnOnDerivatives();
   }
@@ -43,7 +42,7 @@ void Bias::registerKeywords( Keywords& keys ){
   ActionPilot::registerKeywords(keys);
   ActionWithValue::registerKeywords(keys);
   ActionWithArguments::registerKeywords(keys);
-  keys.add("hidden","STRIDE","the frequency with which the forces due to the bias should be calculated.  This can be used to correctly set up multistep algorithms");
+  keys.add("compulsory","STRIDE","1","the frequency with which the forces due to the bias should be calculated.  Forces are multiplied by the stride, so that this can be used to set up multiple time stepping algorithms.  The bias energy passed to the MD code only includes this bias on the same steps");
 }
 
 void Bias::turnOnDerivatives(){
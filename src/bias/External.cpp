@@ -97,6 +97,7 @@ class External : public Bias{
 
 private:
   Grid* BiasGrid_;
+  Value* valueBias;
   
 public:
   External(const ActionOptions&);
@@ -141,6 +142,7 @@ BiasGrid_(NULL)
   if(sparsegrid){log.printf("  External potential uses sparse grid\n");}
   
   addComponent("bias"); componentIsNotPeriodic("bias");
+  valueBias=getPntrToComponent("bias");
 
 // read grid
   IFile gridfile; gridfile.open(filename);
@@ -162,7 +164,7 @@ void External::calculate()
 
   double ene=BiasGrid_->getValueAndDerivatives(cv,der);
 
-  getPntrToComponent("bias")->set(ene);
+  valueBias->set(ene);
 
 // set Forces 
   for(unsigned i=0;i<ncv;++i){
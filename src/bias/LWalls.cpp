@@ -70,6 +70,8 @@ class LWalls : public Bias{
   std::vector<double> exp;
   std::vector<double> eps;
   std::vector<double> offset;
+  Value* valueBias;
+  Value* valueForce2;
 public:
   LWalls(const ActionOptions&);
   void calculate();
@@ -125,6 +127,8 @@ offset(getNumberOfArguments(),0.0)
 
   addComponent("bias"); componentIsNotPeriodic("bias");
   addComponent("force2"); componentIsNotPeriodic("force2");
+  valueBias=getPntrToComponent("bias");
+  valueForce2=getPntrToComponent("force2");
 }
 
 void LWalls::calculate(){
@@ -146,8 +150,8 @@ void LWalls::calculate(){
     }
     setOutputForce(i,f);
   }
-  getPntrToComponent("bias")->set(ene); 
-  getPntrToComponent("force2")->set(totf2);  
+  valueBias->set(ene);
+  valueForce2->set(totf2);
 }
 
 }
@@ -28,6 +28,10 @@
 #include "core/FlexibleBin.h"
 #include "tools/Matrix.h"
 #include "tools/Random.h"
+#include "tools/HillIndex.h"
+#include "tools/SharedRingBuffer.h"
+#include "tools/AsyncGridWriter.h"
+#include "tools/Arena.h"
 #include <string>
 #include <cstring>
 #include "tools/File.h"
@@ -83,6 +87,10 @@ the most conservative choice (highest number of bins) for each dimension.
 In case you do not provide any information about bin size (neither GRID_BIN nor GRID_SPACING)
 and if Gaussian width is fixed PLUMED will use 1/5 of the Gaussian width as grid spacing.
 This default choice should be reasonable for most applications.
+When no grid is used, the deposited Gaussians are kept in a spatial index so that at every step
+only those whose support contains the current point are evaluated. The cost then grows with the
+number of Gaussians deposited close to the current point rather than with the total number of Gaussians.
+This also applies to adaptive Gaussians, which cannot be used without SIGMA_MIN on a grid.
 
 Another option that is available in plumed 2.0 is well-tempered metadynamics \cite Barducci:2008. In this
 varient of metadynamics the heights of the Gaussian hills are rescaled at each step so the bias is now
@@ -206,6 +214,14 @@ id of the present walker (starting from 0 ) and the WALKERS_DIR is the directory
 where all the walkers are located. WALKERS_RSTRIDE is the number of step between 
 one update and the other. 
 
+When all the walkers run on the same host, the WALKERS_SHM flag can be added.
+Each walker then also publishes its hills in binary form in a shared memory segment, and
+reads the hills of the other walkers from their segments at every step, without
+parsing their HILLS files. WALKERS_RSTRIDE is then only used to look for walkers that have
+not started yet or that have been restarted. The HILLS files are still written, so that the simulation can be restarted,
+and they are read if a walker falls so much behind that some hills are not in the
+shared memory any more.
+
 \par
 The kinetics of the transitions between basins can also be analysed on the fly as
 in \cite PRL230602. The flag ACCELERATION turn on accumulation of the acceleration
@@ -235,8 +251,10 @@ private:
   vector<double> sigma0min_;
   vector<double> sigma0max_;
   vector<Gaussian> hills_;
+  HillIndex* hillIndex_;
+  vector<unsigned> hillCandidates_;
   OFile hillsOfile_;
-  OFile gridfile_;
+  AsyncGridWriter gridwriter_;
   Grid* BiasGrid_;
   Grid* ExtGrid_;
   bool storeOldGrids_;
@@ -255,17 +273,27 @@ private:
   string mw_dir_;
   int mw_id_;
   int mw_rstride_;
+  int mw_shm_capacity_;
   bool walkers_mpi;
   bool acceleration;
   double acc;
+  Value* valueBias;
+  Value* valueAcc;
   vector<IFile*> ifiles;
   vector<string> ifilesnames;
+  bool mw_shm_;
+  vector<SharedRingBuffer*> mw_rings_;
+  vector<unsigned long> mw_nread_;
   double uppI_;
   double lowI_;
   bool doInt_;
   bool isFirstStep;
   
-  void   readGaussians(IFile*);
+  unsigned readGaussians(IFile*);
+  unsigned getHillRecordSize();
+  void   pushSharedGaussian(const Gaussian&);
+  void   readSharedGaussians();
+  void   readWalkerGaussiansFromFile(int walker,unsigned long last);
   bool   readChunkOfGaussians(IFile *ifile, unsigned n);
   void   writeGaussian(const Gaussian&,OFile&);
   void   addGaussian(const Gaussian&);
@@ -274,6 +302,7 @@ private:
   double evaluateGaussian(const vector<double>&, const Gaussian&,double* der=NULL);
   void   finiteDifferenceGaussian(const vector<double>&, const Gaussian&);
   vector<unsigned> getGaussianSupport(const Gaussian&);
+  vector<double> getGaussianHalfWidths(const Gaussian&);
   bool   scanOneHill(IFile *ifile,  vector<Value> &v, vector<double> &center, vector<double>  &sigma, double &height, bool &multivariate  );
   std::string fmt;
 
@@ -282,6 +311,7 @@ public:
   ~MetaD();
   void calculate();
   void update();
+  void checkEvaluationStride();
   static void registerKeywords(Keywords& keys);
   bool checkNeedsGradients()const{if(adaptive_==FlexibleBin::geometry){return true;}else{return false;}}
 };
@@ -321,24 +351,28 @@ void MetaD::registerKeywords(Keywords& keys){
   keys.add("optional","SIGMA_MAX","the upper bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
   keys.add("optional","SIGMA_MIN","the lower bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
   keys.addFlag("WALKERS_MPI",false,"Switch on MPI version of multiple walkers - not compatible with other WALKERS_* options");
+  keys.addFlag("WALKERS_SHM",false,"exchange hills among multiple walkers running on the same host through shared memory - requires WALKERS_N");
+  keys.add("optional","WALKERS_SHM_CAPACITY","number of hills kept in the shared memory segment of each walker. By default, the hills added in ten times WALKERS_RSTRIDE steps");
   keys.addFlag("ACCELERATION",false,"Set to TRUE if you want to compute the metadynamics acceleration factor.");  
 }
 
 MetaD::~MetaD(){
   if(flexbin) delete flexbin;
   if(BiasGrid_) delete BiasGrid_;
+  if(hillIndex_) delete hillIndex_;
   hillsOfile_.close();
-  if(wgridstride_>0) gridfile_.close();
   delete [] dp_;
   // close files
   for(int i=0;i<mw_n_;++i){
    if(ifiles[i]->isOpen()) ifiles[i]->close();
    delete ifiles[i];
   }
+  for(unsigned i=0;i<mw_rings_.size();++i) delete mw_rings_[i];
 }
 
 MetaD::MetaD(const ActionOptions& ao):
 PLUMED_BIAS_INIT(ao),
+hillIndex_(NULL),
 // Grid stuff initialization
 BiasGrid_(NULL),ExtGrid_(NULL), wgridstride_(0), grid_(false), hasextgrid_(false),
 // Metadynamics basic parameters
@@ -348,9 +382,10 @@ stride_(0), welltemp_(false),
 dp_(NULL), adaptive_(FlexibleBin::none),
 flexbin(NULL),
 // Multiple walkers initialization
-mw_n_(1), mw_dir_("./"), mw_id_(0), mw_rstride_(1),
+mw_n_(1), mw_dir_("./"), mw_id_(0), mw_rstride_(1), mw_shm_capacity_(0),
 walkers_mpi(false),
-acceleration(false), acc(0.0),
+acceleration(false), acc(0.0), valueBias(NULL), valueAcc(NULL),
+mw_shm_(false),
 // Interval initialization
 uppI_(-1), lowI_(-1), doInt_(false),
 isFirstStep(true)
@@ -513,6 +548,17 @@ isFirstStep(true)
   // MPI version
   parseFlag("WALKERS_MPI",walkers_mpi);
 
+  // Shared memory version
+  parseFlag("WALKERS_SHM",mw_shm_);
+  if(mw_shm_){
+   if(mw_n_<=1) error("WALKERS_SHM can only be used with WALKERS_N");
+   if(!SharedRingBuffer::available()) error("WALKERS_SHM cannot be used as plumed was compiled without shared memory support");
+// older hills are read from the HILLS files, so the segment only needs to cover the lag among walkers
+   mw_shm_capacity_=10*(mw_rstride_/stride_+1);
+   parse("WALKERS_SHM_CAPACITY",mw_shm_capacity_);
+   if(mw_shm_capacity_<2) error("WALKERS_SHM_CAPACITY should be at least 2");
+  }
+
   // Inteval keyword
   vector<double> tmpI(2);
   parseVector("INTERVAL",tmpI);
@@ -568,16 +614,19 @@ isFirstStep(true)
    log.printf("  walker id %d\n",mw_id_);
    log.printf("  reading stride %d\n",mw_rstride_);
    log.printf("  directory with hills files %s\n",mw_dir_.c_str());
+   if(mw_shm_) log.printf("  hills are exchanged through shared memory, keeping the last %d of each walker\n",mw_shm_capacity_);
   } else {
    if(walkers_mpi) log.printf("  Multiple walkers active using MPI communnication\n"); 
   }
 
   addComponent("bias"); componentIsNotPeriodic("bias");
+  valueBias=getPntrToComponent("bias");
 
   if(acceleration) {
     if(!welltemp_) error("The calculation of the acceleration works only if Well-Tempered Metadynamics is on"); 
     log.printf("  calculation on the fly of the acceleration factor");
     addComponent("acc"); componentIsNotPeriodic("acc");
+    valueAcc=getPntrToComponent("acc");
   }
 
 // for performance
@@ -604,11 +653,25 @@ isFirstStep(true)
      if(gmin[i]!=actualmin[i]) log<<"  WARNING: GRID_MIN["<<i<<"] has been adjusted to "<<actualmin[i]<<" to fit periodicity\n";
      if(gmax[i]!=actualmax[i]) log<<"  WARNING: GRID_MAX["<<i<<"] has been adjusted to "<<actualmax[i]<<" to fit periodicity\n";
    }
+  } else {
+   // without grid, hills are indexed in space to only evaluate the close ones
+   vector<bool> periodic(getNumberOfArguments());
+   vector<double> pmin(getNumberOfArguments(),0.0),pmax(getNumberOfArguments(),0.0);
+   for(unsigned i=0;i<getNumberOfArguments();i++){
+     periodic[i]=getPntrToArgument(i)->isPeriodic();
+     if(periodic[i]) getPntrToArgument(i)->getDomain(pmin[i],pmax[i]);
+   }
+   hillIndex_=new HillIndex(periodic,pmin,pmax);
   }
 
   if(wgridstride_>0){
-    gridfile_.link(*this);
-    gridfile_.open(gridfilename_);
+// the file is opened here to take care of backups and suffixes,
+// then grids are written to it in background
+    OFile gridfile;
+    gridfile.link(*this);
+    gridfile.open(gridfilename_);
+    gridwriter_.setFile(gridfile.getPath(),storeOldGrids_);
+    gridfile.close();
   }
 
 // initializing external grid
@@ -628,6 +691,7 @@ isFirstStep(true)
 
 // creating vector of ifile* for hills reading 
 // open all files at the beginning and read Gaussians if restarting
+  mw_nread_.assign(mw_n_,0);
   for(int i=0;i<mw_n_;++i){
    string fname;
    if(mw_n_>1) {
@@ -644,7 +708,7 @@ isFirstStep(true)
     ifile->open(fname);
     if(plumed.getRestart()){
      log.printf("  Restarting from %s:",ifilesnames[i].c_str());                  
-     readGaussians(ifiles[i]);                                                    
+     mw_nread_[i]=readGaussians(ifiles[i]);
     }
     ifiles[i]->reset(false);
     // close only the walker own hills file for later writing
@@ -665,6 +729,13 @@ isFirstStep(true)
 // output periodicities of variables
   for(unsigned i=0;i<getNumberOfArguments();++i) hillsOfile_.setupPrintValue( getPntrToArgument(i) );
 
+// shared memory segments for multiple walkers; hills in our own segment are numbered
+// after those already in the hills file
+  if(mw_shm_){
+   for(int i=0;i<mw_n_;++i) mw_rings_.push_back(new SharedRingBuffer());
+   if(comm.Get_rank()==0) mw_rings_[mw_id_]->create(SharedRingBuffer::getNameForFile(ifilesnames[mw_id_]),getHillRecordSize(),mw_shm_capacity_,mw_nread_[mw_id_]);
+  }
+
   log<<"  Bibliography "<<plumed.cite("Laio and Parrinello, PNAS 99, 12562 (2002)");
   if(welltemp_) log<<plumed.cite(
     "Barducci, Bussi, and Parrinello, Phys. Rev. Lett. 100, 020603 (2008)");
@@ -680,7 +751,7 @@ isFirstStep(true)
 
 }
 
-void MetaD::readGaussians(IFile *ifile)
+unsigned MetaD::readGaussians(IFile *ifile)
 {
  unsigned ncv=getNumberOfArguments();
  vector<double> center(ncv);
@@ -698,6 +769,98 @@ void MetaD::readGaussians(IFile *ifile)
   addGaussian(Gaussian(center,sigma,height,multivariate));
  }     
  log.printf("      %d Gaussians read\n",nhills);
+ return nhills;
+}
+
+unsigned MetaD::getHillRecordSize()
+{
+ // center, sigma (possibly the full matrix), height and multivariate flag
+ unsigned ncv=getNumberOfArguments();
+ return ncv+(ncv*(ncv+1))/2+2;
+}
+
+void MetaD::pushSharedGaussian(const Gaussian& hill)
+{
+ if(comm.Get_rank()!=0) return;
+ unsigned ncv=getNumberOfArguments();
+ vector<double> record(getHillRecordSize(),0.0);
+ for(unsigned i=0;i<ncv;++i) record[i]=hill.center[i];
+ for(unsigned i=0;i<hill.sigma.size();++i) record[ncv+i]=hill.sigma[i];
+ record[record.size()-2]=hill.height;
+ record[record.size()-1]=(hill.multivariate?1.0:0.0);
+ mw_rings_[mw_id_]->push(&record[0]);
+}
+
+void MetaD::readSharedGaussians()
+{
+ unsigned ncv=getNumberOfArguments();
+ unsigned rsize=getHillRecordSize();
+ bool tryattach=(getStep()%mw_rstride_==0);
+ vector<double> buffer;
+ for(int i=0;i<mw_n_;++i){
+  if(i==mw_id_) continue;
+  // only the root of each walker reads the shared memory, then hills are shared with the group
+  unsigned long first=mw_nread_[i];
+  unsigned long nbuffer=0;
+  buffer.resize(0);
+  if(comm.Get_rank()==0){
+   SharedRingBuffer* ring=mw_rings_[i];
+// the walker might have been restarted, replacing its segment with a new one; this is
+// usually flagged in the old segment, and the name is only checked when looking for new walkers
+   if(ring->isOpen() && (!ring->isLive() || (tryattach && !ring->isCurrent()))) ring->attach(SharedRingBuffer::getNameForFile(ifilesnames[i]));
+   if(!ring->isOpen() && tryattach) ring->attach(SharedRingBuffer::getNameForFile(ifilesnames[i]));
+   if(ring->isOpen()){
+    if(ring->getRecordSize()!=rsize) error("walker "+ifilesnames[i]+" is not using the same number of arguments");
+    first=ring->read(mw_nread_[i],buffer);
+   }
+   nbuffer=buffer.size();
+  }
+  comm.Bcast(first,0);
+  comm.Bcast(nbuffer,0);
+  if(nbuffer>0){
+   buffer.resize(nbuffer);
+   comm.Bcast(buffer,0);
+  }
+  // hills which are not in the shared memory any more are read from the hills file
+  if(first>mw_nread_[i]) readWalkerGaussiansFromFile(i,first);
+  for(unsigned long k=0;k<nbuffer;k+=rsize){
+   const double* record=&buffer[k];
+   bool multivariate=(record[rsize-1]!=0.0);
+   vector<double> center(record,record+ncv);
+   vector<double> sigma(record+ncv,record+ncv+(multivariate?(ncv*(ncv+1))/2:ncv));
+   addGaussian(Gaussian(center,sigma,record[rsize-2],multivariate));
+  }
+  mw_nread_[i]=first+nbuffer/rsize;
+ }
+}
+
+void MetaD::readWalkerGaussiansFromFile(int walker,unsigned long last)
+{
+ unsigned ncv=getNumberOfArguments();
+ vector<double> center(ncv);
+ vector<double> sigma(ncv);
+ double height;
+ bool multivariate=false;
+ std::vector<Value> tmpvalues;
+ for(unsigned j=0;j<getNumberOfArguments();++j) tmpvalues.push_back( Value( this, getPntrToArgument(j)->getName(), false ) ); 
+
+ log.printf("  Reading hills from %s:",ifilesnames[walker].c_str());
+ IFile ifile;
+ ifile.link(*this);
+ ifile.open(ifilesnames[walker]);
+ // skip the hills that have already been read
+ unsigned long nhills=0;
+ while(nhills<last && scanOneHill(&ifile,tmpvalues,center,sigma,height,multivariate)){
+  if(nhills>=mw_nread_[walker]){
+   if(welltemp_){height*=(biasf_-1.0)/biasf_;}
+   addGaussian(Gaussian(center,sigma,height,multivariate));
+  }
+  nhills++;
+ }
+ ifile.close();
+ if(nhills<last) error("file "+ifilesnames[walker]+" contains fewer hills than expected");
+ log.printf("      %lu Gaussians read\n",last-mw_nread_[walker]);
+ mw_nread_[walker]=last;
 }
 
 bool MetaD::readChunkOfGaussians(IFile *ifile, unsigned n)
@@ -773,7 +936,10 @@ void MetaD::writeGaussian(const Gaussian& hill, OFile&file){
 
 void MetaD::addGaussian(const Gaussian& hill)
 {
- if(!grid_){hills_.push_back(hill);} 
+ if(!grid_){
+   hills_.push_back(hill);
+   hillIndex_->add(hill.center,getGaussianHalfWidths(hill));
+ }
  else{
   unsigned ncv=getNumberOfArguments();
   vector<unsigned> nneighb=getGaussianSupport(hill);
@@ -791,8 +957,8 @@ void MetaD::addGaussian(const Gaussian& hill)
   } else {
     unsigned stride=comm.Get_size();
     unsigned rank=comm.Get_rank();
-    vector<double> allder(ncv*neighbors.size(),0.0);
-    vector<double> allbias(neighbors.size(),0.0);
+    ArenaVector<double>::type allder(ncv*neighbors.size(),0.0);
+    ArenaVector<double>::type allbias(neighbors.size(),0.0);
     for(unsigned i=rank;i<neighbors.size();i+=stride){
      unsigned ineigh=neighbors[i];
      BiasGrid_->getPoint(ineigh,xx);
@@ -861,13 +1027,54 @@ vector<unsigned> MetaD::getGaussianSupport(const Gaussian& hill)
  return nneigh;
 }
 
+vector<double> MetaD::getGaussianHalfWidths(const Gaussian& hill)
+{
+ unsigned ncv=getNumberOfArguments();
+ vector<double> halfwidth(ncv,std::numeric_limits<double>::max());
+ if(hill.multivariate){
+   // the support is an ellipsoid, its extent along i is sqrt(2*DP2CUTOFF*C_ii)
+   // with C the inverse of the matrix stored in the hill
+   unsigned k=0;
+   Matrix<double> mymatrix(ncv,ncv);
+   for(unsigned i=0;i<ncv;i++){
+     for(unsigned j=i;j<ncv;j++){
+       mymatrix(i,j)=mymatrix(j,i)=hill.sigma[k];
+       k++;
+     }
+   }
+   Matrix<double> myinv(ncv,ncv);
+   Invert(mymatrix,myinv);
+   for(unsigned i=0;i<ncv;i++){
+     // a degenerate hill is treated as infinitely wide
+     if(myinv(i,i)>0.0) halfwidth[i]=sqrt(2.0*DP2CUTOFF*myinv(i,i));
+   }
+ }else{
+   for(unsigned i=0;i<ncv;i++){
+     // a zero width corresponds to a hill which is flat in that direction
+     if(abs(hill.sigma[i])>1.e-20) halfwidth[i]=sqrt(2.0*DP2CUTOFF)*abs(hill.sigma[i]);
+   }
+ }
+ return halfwidth;
+}
+
 double MetaD::getBiasAndDerivatives(const vector<double>& cv, double* der)
 {
  double bias=0.0;
  if(!grid_){
   unsigned stride=comm.Get_size();
   unsigned rank=comm.Get_rank();
-  for(unsigned i=rank;i<hills_.size();i+=stride){
+  // only the hills whose support contains the point are evaluated;
+  // with INTERVAL hills are evaluated at the closest point in the interval
+  if(doInt_){
+    vector<double> icv(cv);
+    if(icv[0]<lowI_) icv[0]=lowI_;
+    if(icv[0]>uppI_) icv[0]=uppI_;
+    hillIndex_->getCandidates(icv,hillCandidates_);
+  } else hillIndex_->getCandidates(cv,hillCandidates_);
+  // candidates are sorted, and are distributed as hills_ would be
+  for(unsigned k=0;k<hillCandidates_.size();++k){
+   unsigned i=hillCandidates_[k];
+   if(i%stride!=rank) continue;
    bias+=evaluateGaussian(cv,hills_[i],der);
    //finite difference test 
    //finiteDifferenceGaussian(cv,hills_[i]);
@@ -991,23 +1198,27 @@ void MetaD::calculate()
   vector<double> cv(ncv);
   for(unsigned i=0;i<ncv;++i){cv[i]=getArgument(i);}
 
-  double* der=new double[ncv];
-  for(unsigned i=0;i<ncv;++i){der[i]=0.0;}
-  double ene=getBiasAndDerivatives(cv,der);
-  getPntrToComponent("bias")->set(ene);
+  ArenaVector<double>::type der(ncv,0.0);
+  double ene=getBiasAndDerivatives(cv,&der[0]);
+  valueBias->set(ene);
 // calculate the acceleration factor
   if(acceleration&&!isFirstStep) {
     acc += exp(ene/(kbt_));
     double mean_acc = acc/((double) getStep());
-    getPntrToComponent("acc")->set(mean_acc);
+    valueAcc->set(mean_acc);
   }
 // set Forces 
   for(unsigned i=0;i<ncv;++i){
    const double f=-der[i];
    setOutputForce(i,f);
   }
+}
 
-  delete [] der;
+void MetaD::checkEvaluationStride(){
+// hills are added and grids written only on the steps where update() is called
+  checkPeriod("PACE",stride_);
+  checkPeriod("GRID_WSTRIDE",wgridstride_);
+  if(mw_n_>1) checkPeriod("WALKERS_RSTRIDE",mw_rstride_);
 }
 
 void MetaD::update(){
@@ -1084,28 +1295,27 @@ void MetaD::update(){
      addGaussian(newhill);
 // print on HILLS file
      writeGaussian(newhill,hillsOfile_);
+// the record is published after the file has been flushed, so that other walkers
+// can always find in the file the hills they missed in shared memory
+     if(mw_shm_){
+       hillsOfile_.flush();
+       pushSharedGaussian(newhill);
+     }
    }
   }
 // dump grid on file
   if(wgridstride_>0&&getStep()%wgridstride_==0){
-// in case old grids are stored, a sequence of grids should appear
-// this call results in a repetition of the header:
-    if(storeOldGrids_) gridfile_.clearFields();
-// in case only latest grid is stored, file should be rewound
-// this will overwrite previously written grids
-    else gridfile_.rewind();
-    BiasGrid_->writeToFile(gridfile_); 
-// if a single grid is stored, it is necessary to flush it, otherwise
-// the file might stay empty forever (when a single grid is not large enough to
-// trigger flushing from the operating system).
-// on the other hand, if grids are stored one after the other this is
-// no necessary, and we leave the flushing control to the user as usual
-// (with FLUSH keyword)
-    if(!storeOldGrids_) gridfile_.flush();
+// the grid is copied and written by a background thread, while the simulation goes on.
+// in case old grids are stored, a sequence of grids is appended to the file,
+// otherwise each grid replaces the previous one with an atomic rename,
+// so that the file always contains a complete grid
+    if(comm.Get_rank()==0) gridwriter_.dump(*BiasGrid_);
   }
 
+// if multiple walkers and shared memory, read Gaussians at every step
+ if(mw_shm_) readSharedGaussians();
 // if multiple walkers and time to read Gaussians
- if(mw_n_>1 && getStep()%mw_rstride_==0){
+ else if(mw_n_>1 && getStep()%mw_rstride_==0){
    for(int i=0;i<mw_n_;++i){
     // don't read your own Gaussians
     if(i==mw_id_) continue;
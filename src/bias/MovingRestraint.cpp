@@ -110,6 +110,11 @@ class MovingRestraint : public Bias{
   std::vector<double> oldf;
   std::vector<string> verse;
   std::vector<double> work;
+  std::vector<Value*> valueCntr;
+  std::vector<Value*> valueWork;
+  std::vector<Value*> valueKappa;
+  Value* valueBias;
+  Value* valueForce2;
 public:
   MovingRestraint(const ActionOptions&);
   void calculate();
@@ -187,17 +192,19 @@ verse(getNumberOfArguments())
 
   addComponent("bias"); componentIsNotPeriodic("bias");
   addComponent("force2"); componentIsNotPeriodic("force2");
+  valueBias=getPntrToComponent("bias");
+  valueForce2=getPntrToComponent("force2");
 
   // add the centers of the restraint as additional components that can be retrieved (useful for debug)
 
   std::string comp;
   for(unsigned i=0;i< getNumberOfArguments() ;i++){
 	comp=getPntrToArgument(i)->getName()+"_cntr"; // each spring has its own center 
-        addComponent(comp); componentIsNotPeriodic(comp);
+        addComponent(comp); componentIsNotPeriodic(comp); valueCntr.push_back(getPntrToComponent(comp));
 	comp=getPntrToArgument(i)->getName()+"_work"; // each spring has its own work
-        addComponent(comp); componentIsNotPeriodic(comp);
+        addComponent(comp); componentIsNotPeriodic(comp); valueWork.push_back(getPntrToComponent(comp));
 	comp=getPntrToArgument(i)->getName()+"_kappa"; // each spring has its own kappa 
-        addComponent(comp); componentIsNotPeriodic(comp);
+        addComponent(comp); componentIsNotPeriodic(comp); valueKappa.push_back(getPntrToComponent(comp));
         work.push_back(0.); // initialize the work value 
   }
 
@@ -233,7 +240,7 @@ void MovingRestraint::calculate(){
   }
   for(unsigned i=0;i<narg;++i){
     const double cv=difference(i,aa[i],getArgument(i)); // this gives: getArgument(i) - aa[i]
-    getPntrToComponent(getPntrToArgument(i)->getName()+"_cntr")->set(aa[i]); 
+    valueCntr[i]->set(aa[i]); 
     const double k=kk[i];
     f[i]=-k*cv;
     if(verse[i]=="U" && cv<0) continue;
@@ -241,8 +248,8 @@ void MovingRestraint::calculate(){
     plumed_assert(verse[i]=="U" || verse[i]=="L" || verse[i]=="B");
     dpotdk[i]=0.5*cv*cv;
     if(oldaa.size()==aa.size() && oldf.size()==f.size()) work[i]+=0.5*(oldf[i]+f[i])*(aa[i]-oldaa[i]) + 0.5*( dpotdk[i]+olddpotdk[i] )*(kk[i]-oldk[i]);
-    getPntrToComponent(getPntrToArgument(i)->getName()+"_work")->set(work[i]); 
-    getPntrToComponent(getPntrToArgument(i)->getName()+"_kappa")->set(kk[i]); 
+    valueWork[i]->set(work[i]); 
+    valueKappa[i]->set(kk[i]); 
     ene+=0.5*k*cv*cv;
     setOutputForce(i,f[i]);
     totf2+=f[i]*f[i];
@@ -251,8 +258,8 @@ void MovingRestraint::calculate(){
   oldaa=aa;
   oldk=kk;
   olddpotdk=dpotdk;
-  getPntrToComponent("bias")->set(ene);
-  getPntrToComponent("force2")->set(totf2);
+  valueBias->set(ene);
+  valueForce2->set(totf2);
 }
 
 }
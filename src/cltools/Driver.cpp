@@ -32,6 +32,8 @@
 #include "tools/Units.h"
 #include "tools/PDB.h"
 #include "tools/FileBase.h"
+#include "tools/XdrFile.h"
+#include "tools/DcdFile.h"
 
 // when using molfile plugin
 #ifdef __PLUMED_HAS_MOLFILE
@@ -49,11 +51,6 @@ using namespace PLMD::molfile;
 #endif
 #endif
 
-#ifdef __PLUMED_HAS_XDRFILE
-#include <xdrfile/xdrfile_trr.h>
-#include <xdrfile/xdrfile_xtc.h>
-#endif
-
 using namespace std;
 
 namespace PLMD {
@@ -113,10 +110,23 @@ configure [...] LDFLAGS="-ltcl8.5 -L/mypathtomolfilelibrary/ -L/mypathtotcl" CPP
 
 and rebuild. Check the available molfile plugins and limitations at http://www.ks.uiuc.edu/Research/vmd/plugins/molfile/.
 
-Additionally, you can use the xdrfile implementation of xtc and trr. To this aim, just
-download and install properly the xdrfile library (see here: http://www.gromacs.org/Developer_Zone/Programming_Guide/XTC_Library)
-Notice that the xdrfile implementation of xtc and trr
+Additionally, xtc and trr files can be read with the --ixtc and --itrr options, which
+use the implementation that is built into PLUMED.
+Notice that this implementation of xtc and trr
 is more robust than the molfile one, since it provides support for generic cell shapes.
+Frames are decoded in advance by a number of background threads that is controlled by --xdr-threads.
+
+Large dcd trajectories can be read with the --idcd option. The file is mapped in memory and
+positions are taken from it directly. Since any frame can be reached without reading the ones
+before it, a subset of the frames can be analyzed using --dcd-first-frame and --dcd-frame-stride.
+The step passed to plumed is still the index of the frame times --trajectory-stride, so that
+the STRIDE keywords and the times that are printed refer to the original simulation.
+The following command analyzes one frame every ten, starting from the hundredth,
+of a trajectory written every 500 steps:
+
+\verbatim
+plumed driver --plumed plumed.dat --idcd traj.dcd --dcd-first-frame 100 --dcd-frame-stride 10 --trajectory-stride 500 --timestep 0.002
+\endverbatim
 
 
 */
@@ -160,10 +170,12 @@ void Driver<real>::registerKeywords( Keywords& keys ){
   keys.addFlag("--noatoms",false,"don't read in a trajectory.  Just use colvar files as specified in plumed.dat");
   keys.add("atoms","--ixyz","the trajectory in xyz format");
   keys.add("atoms","--igro","the trajectory in gro format");
-#ifdef __PLUMED_HAS_XDRFILE
-  keys.add("atoms","--ixtc","the trajectory in xtc format (xdrfile implementation");
-  keys.add("atoms","--itrr","the trajectory in trr format (xdrfile implementation");
-#endif
+  keys.add("atoms","--ixtc","the trajectory in xtc format");
+  keys.add("atoms","--itrr","the trajectory in trr format");
+  keys.add("atoms","--idcd","the trajectory in dcd format");
+  keys.add("compulsory","--dcd-first-frame","0","the index of the first frame of the dcd trajectory that is analyzed");
+  keys.add("compulsory","--dcd-frame-stride","1","analyze only one frame every this number of frames of the dcd trajectory");
+  keys.add("compulsory","--xdr-threads","2","the number of threads decoding the frames of xtc and trr trajectories in advance, 0 to decode each frame when it is needed");
   keys.add("optional","--length-units","units for length, either as a string or a number");
   keys.add("optional","--dump-forces","dump the forces on a file");
   keys.add("optional","--dump-forces-fmt","( default=%%f ) the format to use to dump the forces");
@@ -287,15 +299,20 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
 // Read in an xyz file
   string trajectoryFile(""), pdbfile("");
   bool pbc_cli_given=false; vector<double> pbc_cli_box(9,0.0);
+  unsigned xdrThreads=0;
+  unsigned dcdFrame=0, dcdFrameStride=1;
   if(!noatoms){
      std::string traj_xyz; parse("--ixyz",traj_xyz);
      std::string traj_gro; parse("--igro",traj_gro);
      std::string traj_xtc;
      std::string traj_trr;
-#ifdef __PLUMED_HAS_XDRFILE
      parse("--ixtc",traj_xtc);
      parse("--itrr",traj_trr);
-#endif
+     parse("--xdr-threads",xdrThreads);
+     std::string traj_dcd; parse("--idcd",traj_dcd);
+     parse("--dcd-first-frame",dcdFrame);
+     parse("--dcd-frame-stride",dcdFrameStride);
+     if(dcdFrameStride==0) error("--dcd-frame-stride should be positive");
 #ifdef __PLUMED_HAS_MOLFILE 
      for(int i=0;i<plugins.size();i++){ 	
 	string molfile_key="--mf_"+string(plugins[i]->name);
@@ -316,6 +333,7 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
        if(traj_gro.length()>0) nn++;
        if(traj_xtc.length()>0) nn++;
        if(traj_trr.length()>0) nn++;
+       if(traj_dcd.length()>0) nn++;
        if(nn>1){
          fprintf(stderr,"ERROR: cannot provide more than one trajectory file\n");
          if(grex_log)fclose(grex_log);
@@ -338,6 +356,11 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
        trajectoryFile=traj_trr;
        trajectory_fmt="xdr-trr";
      }
+     if(traj_dcd.length()>0 && trajectoryFile.length()==0){
+       trajectoryFile=traj_dcd;
+       trajectory_fmt="dcd";
+     }
+     if(trajectory_fmt!="dcd" && (dcdFrame!=0 || dcdFrameStride!=1)) error("--dcd-first-frame and --dcd-frame-stride can only be used with --idcd");
      if(trajectoryFile.length()==0){
        fprintf(stderr,"ERROR: missing trajectory data\n"); 
        if(grex_log)fclose(grex_log);
@@ -403,10 +426,12 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
   int natoms;
 
   FILE* fp=NULL; FILE* fp_forces=NULL;
-#ifdef __PLUMED_HAS_XDRFILE
-  XDRFILE* xd=NULL;
-#endif
+  XdrReader xd;
+  XdrFrame xdrframe;
+  DcdReader dcd;
+  DcdFrame dcdframe;
   if(!noatoms){
+     if (trajectoryFile=="-" && trajectory_fmt=="dcd") error("dcd trajectories cannot be read from standard input");
      if (trajectoryFile=="-") 
        fp=in;
      else {
@@ -416,16 +441,22 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
         ts_in.coords = new float [3*natoms];
 #endif
        }else if(trajectory_fmt=="xdr-xtc" || trajectory_fmt=="xdr-trr"){
-#ifdef __PLUMED_HAS_XDRFILE
-         xd=xdrfile_open(trajectoryFile.c_str(),"r");
-         if(!xd){
+         if(!xd.open(trajectoryFile)){
            string msg="ERROR: Error opening trajectory file "+trajectoryFile;
            fprintf(stderr,"%s\n",msg.c_str());
            return 1;
          }
-         if(trajectory_fmt=="xdr-xtc") read_xtc_natoms(&trajectoryFile[0],&natoms);
-         if(trajectory_fmt=="xdr-trr") read_trr_natoms(&trajectoryFile[0],&natoms);
-#endif
+         natoms=xd.getNumberOfAtoms();
+         xd.setNumberOfThreads(xdrThreads);
+       }else if(trajectory_fmt=="dcd"){
+         if(!dcd.open(trajectoryFile)){
+           string msg="ERROR: Error opening trajectory file "+trajectoryFile;
+           fprintf(stderr,"%s\n",msg.c_str());
+           return 1;
+         }
+         natoms=dcd.getNumberOfAtoms();
+// the step of the first frame that is analyzed
+         step=dcdFrame*stride;
        }else{
          fp=fopen(trajectoryFile.c_str(),"r");
          if(!fp){
@@ -481,6 +512,13 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
 	         break;
 	  }
 #endif
+       }else if(trajectory_fmt=="xdr-xtc" || trajectory_fmt=="xdr-trr"){
+         if(!xd.next(xdrframe)) break;
+         natoms=xdrframe.natoms;
+       }else if(trajectory_fmt=="dcd"){
+         if(dcdFrame>=dcd.getNumberOfFrames()) break;
+         dcd.readFrame(dcdFrame,dcdframe);
+         dcd.prefetch(dcdFrame+dcdFrameStride);
        }else if(trajectory_fmt=="xyz" || trajectory_fmt=="gro"){
          if(!Tools::getline(fp,line)) break;
        }
@@ -614,22 +652,16 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
     	   }
 #endif
        }else if(trajectory_fmt=="xdr-xtc" || trajectory_fmt=="xdr-trr"){
-#ifdef __PLUMED_HAS_XDRFILE
-         int step;
-         float time;
-         matrix box;
-         rvec* pos=new rvec[natoms];
-         float prec,lambda;
-         int ret;
-         if(trajectory_fmt=="xdr-xtc") ret=read_xtc(xd,natoms,&step,&time,box,pos,&prec);
-         if(trajectory_fmt=="xdr-trr") ret=read_trr(xd,natoms,&step,&time,&lambda,box,pos,NULL,NULL);
-         if(ret==exdrENDOFFILE) break;
-         if(ret!=exdrOK) break;
-         for(unsigned i=0;i<3;i++) for(unsigned j=0;j<3;j++) cell[3*i+j]=box[i][j];
-         for(unsigned i=0;i<natoms;i++) for(unsigned j=0;j<3;j++)
-                 coordinates[3*i+j]=real(pos[i][j]);
-         delete [] pos;
-#endif
+         for(unsigned i=0;i<9;i++) cell[i]=real(xdrframe.box[i]);
+         for(int i=0;i<3*natoms;i++) coordinates[i]=real(xdrframe.positions[i]);
+       }else if(trajectory_fmt=="dcd"){
+// dcd files are in Angstrom
+         for(unsigned i=0;i<9;i++) cell[i]=(pbc_cli_given?real(pbc_cli_box[i]):real(dcdframe.box[i]/10.));
+         for(int i=0;i<natoms;i++){
+           coordinates[3*i]=real(dcdframe.x[i]/10.);
+           coordinates[3*i+1]=real(dcdframe.y[i]/10.);
+           coordinates[3*i+2]=real(dcdframe.z[i]/10.);
+         }
        }else{
        if(trajectory_fmt=="xyz"){
          if(!Tools::getline(fp,line)) error("premature end of trajectory file");
@@ -772,15 +804,15 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc){
 
     if(noatoms && plumedStopCondition) break;
 
-    step+=stride;
+    step+=stride*dcdFrameStride;
+    dcdFrame+=dcdFrameStride;
   }
   p.cmd("runFinalJobs");
 
   if(fp_forces) fclose(fp_forces);
   if(fp && fp!=in)fclose(fp);
-#ifdef __PLUMED_HAS_XDRFILE
-  if(xd) xdrfile_close(xd);
-#endif
+  xd.close();
+  dcd.close();
 #ifdef __PLUMED_HAS_MOLFILE
   if(h_in) api->close_file_read(h_in);
   if(ts_in.coords) delete [] ts_in.coords;
@@ -126,7 +126,13 @@ Additionally, if you want to do histogram and hills from the same file you can d
 \verbatim
 plumed sum_hills --hills --histo PATHTOMYCOLVARORHILLSFILE  --sigma 0.2,0.2 --kt 0.6  
 \endverbatim
-The two files can be eventually the same 
+The two files can be eventually the same
+
+When the file used for the histogram is very long you can use --binned.  The points are then binned on the grid
+and the result is convolved with the gaussian, which makes the cost independent of the number of points 
+\verbatim
+plumed sum_hills --histo PATHTOMYCOLVARORHILLSFILE  --sigma 0.2,0.2 --kt 0.6 --binned 
+\endverbatim 
 
 Another interesting thing one can do is monitor the difference in blocks as a metadynamics goes on. 
 When the bias deposited is constant over the whole domain one can consider to be at convergence. 
@@ -215,6 +221,7 @@ void CLToolSumHills::registerKeywords( Keywords& keys ){
   keys.addFlag("--negbias",false," print the negative bias instead of the free energy (only needed with welltempered runs and flexible hills) ");
   keys.addFlag("--nohistory",false," to be used with --stride:  it splits the bias/histogram in pieces without previous history ");
   keys.addFlag("--mintozero",false," it translate all the minimum value in bias/histogram to zero (usefull to compare results) ");
+  keys.addFlag("--binned",false," build the histogram by binning the points on the grid and then convolving with the gaussian (much faster for large files) ");
   keys.add("optional","--fmt","specify the output format");
 }
 
@@ -508,6 +515,10 @@ int CLToolSumHills::main(FILE* in,FILE*out,Communicator& pc){
         for(unsigned i=0;i<sigma.size()-1;i++){addme+=sigma[i]+",";}
         addme+=sigma.back();  
 	actioninput.push_back(addme);
+
+        bool binned;
+        parseFlag("--binned",binned);
+        if(binned) actioninput.push_back("HISTOBINNED");
   } 
  
   bool negbias;
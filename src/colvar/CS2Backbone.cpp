@@ -134,11 +134,17 @@ class CS2Backbone : public Colvar {
   double for_pl2alm;
   Coor<double> coor; 
   Coor<double> csforces;
+/// Pending ensemble average among replicas
+  Communicator::Request ensreq;
+/// Calculate the local chemical shifts and start the ensemble average
+  void calculateLocal();
 public:
   CS2Backbone(const ActionOptions&);
   ~CS2Backbone();
   static void registerKeywords( Keywords& keys );
   virtual void calculate();
+  virtual bool startCalculation();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(CS2Backbone,"CS2BACKBONE")
@@ -338,6 +344,20 @@ CS2Backbone::~CS2Backbone()
 }
 
 void CS2Backbone::calculate()
+{
+  calculateLocal();
+  finishCalculation();
+}
+
+bool CS2Backbone::startCalculation()
+{
+  // only the ensemble average can overlap with other actions
+  if(!ensemble) return false;
+  calculateLocal();
+  return true;
+}
+
+void CS2Backbone::calculateLocal()
 {
   for(unsigned i=0;i<numResidues;i++) for(unsigned j=0;j<6;j++) sh[i][j]=0.;
   if(getExchangeStep()) cam_list[0].set_box_count(0);
@@ -361,12 +381,21 @@ void CS2Backbone::calculate()
     cam_list[0].printout_chemical_shifts(csfile.c_str(), sh);
   }
 
+  if(ensemble && comm.Get_rank()==0) { // I am the master of my replica
+    // among replicas
+    ensreq=multi_sim_comm.Isum(&sh[0][0], numResidues*6);
+  }
+}
+
+void CS2Backbone::finishCalculation()
+{
+  unsigned N = getNumberOfAtoms();
+
   double fact=1.0;
   if(ensemble) {
     fact = 1./((double) ens_dim);
-    if(comm.Get_rank()==0) { // I am the master of my replica
-      // among replicas
-      multi_sim_comm.Sum(&sh[0][0], numResidues*6);
+    if(comm.Get_rank()==0) {
+      ensreq.wait();
       for(unsigned i=0;i<6;i++) for(unsigned j=0;j<numResidues;j++) sh[j][i] *= fact; 
     } else for(unsigned i=0;i<6;i++) for(unsigned j=0;j<numResidues;j++) sh[j][i] = 0.;
     // inside each replica
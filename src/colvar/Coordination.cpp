@@ -66,6 +66,13 @@ The following example instructs plumed to calculate the total coordination numbe
 COORDINATION GROUPA=1-10 GROUPB=20-100 R_0=0.3 NLIST NL_CUTOFF=0.5 NL_STRIDE=100 
 \endverbatim
 
+The neighbour list can also be updated only when it is needed. In the following example the switching
+function is zero beyond 0.5 nm, so that the list built with a cutoff of 0.6 nm remains valid until
+some atom has moved by more than half the skin, that is 0.05 nm.
+\verbatim
+COORDINATION GROUPA=1-10 GROUPB=20-100 SWITCH={RATIONAL R_0=0.3 D_MAX=0.5} NLIST NL_CUTOFF=0.6 NL_ADAPTIVE
+\endverbatim
+
 The following is a dummy example which should compute the value 0 because the self interaction
 of atom 1 is skipped. Notice that in plumed 2.0 "self interactions" were not skipped, and the
 same calculation should return 1.
@@ -98,6 +105,7 @@ public:
 // active methods:
   static void registerKeywords( Keywords& keys );
   virtual double pairing(double distance,double&dfunc,unsigned i,unsigned j)const;
+  virtual double getPairingCutoff()const;
 };
 
 PLUMED_REGISTER_ACTION(Coordination,"COORDINATION")
@@ -147,6 +155,10 @@ double Coordination::pairing(double distance,double&dfunc,unsigned i,unsigned j)
   return switchingFunction.calculateSqr(distance,dfunc);
 }
 
+double Coordination::getPairingCutoff()const{
+  return switchingFunction.get_dmax();
+}
+
 }
 
 }
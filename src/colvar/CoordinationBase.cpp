@@ -22,8 +22,11 @@
 #include "CoordinationBase.h"
 #include "tools/NeighborList.h"
 #include "tools/Communicator.h"
+#include "tools/Pbc.h"
+#include "tools/Arena.h"
 
 #include <string>
+#include <limits>
 
 using namespace std;
 
@@ -37,6 +40,8 @@ void CoordinationBase::registerKeywords( Keywords& keys ){
   keys.addFlag("NLIST",false,"Use a neighbour list to speed up the calculation");
   keys.add("optional","NL_CUTOFF","The cutoff for the neighbour list");
   keys.add("optional","NL_STRIDE","The frequency with which we are updating the atoms in the neighbour list");
+  keys.addFlag("NL_ADAPTIVE",false,"Update the neighbour list only when some atom has moved by more than half the skin, that is the difference between NL_CUTOFF and the cutoff of the switching function. "
+                                   "NL_STRIDE is not used. Notice that all the atoms are then requested at every step");
   keys.add("atoms","GROUPA","First list of atoms");
   keys.add("atoms","GROUPB","Second list of atoms (if empty, N*(N-1)/2 pairs in GROUPA are counted)");
 }
@@ -46,7 +51,9 @@ PLUMED_COLVAR_INIT(ao),
 pbc(true),
 serial(false),
 invalidateList(true),
-firsttime(true)
+firsttime(true),
+adaptive(false),
+nl_cut(0.0)
 {
 
   parseFlag("SERIAL",serial);
@@ -65,14 +72,17 @@ firsttime(true)
 
 // neighbor list stuff
   bool doneigh=false;
-  double nl_cut=0.0;
   int nl_st=0;
   parseFlag("NLIST",doneigh);
+  parseFlag("NL_ADAPTIVE",adaptive);
+  if(adaptive && !doneigh) error("NL_ADAPTIVE can only be used together with NLIST");
   if(doneigh){
    parse("NL_CUTOFF",nl_cut);
    if(nl_cut<=0.0) error("NL_CUTOFF should be explicitly specified and positive");
    parse("NL_STRIDE",nl_st);
-   if(nl_st<=0) error("NL_STRIDE should be explicitly specified and positive");
+   if(adaptive){
+     if(nl_st!=0) error("NL_STRIDE cannot be used together with NL_ADAPTIVE");
+   } else if(nl_st<=0) error("NL_STRIDE should be explicitly specified and positive");
   }
   
   addValueWithDerivatives(); setNotPeriodic();
@@ -103,7 +113,8 @@ firsttime(true)
   if(dopair) log.printf("  with PAIR option\n");
   if(doneigh){
    log.printf("  using neighbor lists with\n");
-   log.printf("  update every %d steps and cutoff %f\n",nl_st,nl_cut);
+   if(adaptive) log.printf("  update when atoms move by more than half the skin and cutoff %f\n",nl_cut);
+   else log.printf("  update every %d steps and cutoff %f\n",nl_st,nl_cut);
   }
 }
 
@@ -126,19 +137,41 @@ void CoordinationBase::prepare(){
   }
 }
 
+double CoordinationBase::getPairingCutoff()const{
+  return std::numeric_limits<double>::max();
+}
+
+void CoordinationBase::checkEvaluationStride(){
+// the list is updated in prepare(), which is only called on steps where the colvar is needed
+  checkPeriod("NL_STRIDE",nl->getStride());
+}
+
 // calculator
 void CoordinationBase::calculate()
 {
 
  double ncoord=0.;
  Tensor virial;
- vector<Vector> deriv(getNumberOfAtoms());
+ ArenaVector<Vector>::type deriv(getNumberOfAtoms());
 // deriv.resize(getPositions().size());
 
  if(nl->getStride()>0 && invalidateList){
    nl->update(getPositions());
  }
 
+// here the full list of atoms is always requested, so that displacements can be checked
+ if(adaptive){
+   if(firsttime){
+// the cutoff of the pairing function is only known after construction
+     double cutoff=getPairingCutoff();
+     if(!(cutoff<nl_cut)) error("NL_ADAPTIVE requires a switching function which is zero beyond some distance (e.g. D_MAX) smaller than NL_CUTOFF");
+     nl->setSkin(nl_cut-cutoff);
+     log.printf("  neighbor list of %s uses a skin of %f\n",getLabel().c_str(),nl_cut-cutoff);
+     firsttime=false;
+   }
+   if(nl->needsUpdate(getPositions())) nl->update(getPositions());
+ }
+
  unsigned stride=comm.Get_size();
  unsigned rank=comm.Get_rank();
  if(serial){
@@ -149,26 +182,39 @@ void CoordinationBase::calculate()
    rank=comm.Get_rank();
  }
 
- for(unsigned int i=rank;i<nl->size();i+=stride) {                   // sum over close pairs
- 
-  Vector distance;
-  unsigned i0=nl->getClosePair(i).first;
-  unsigned i1=nl->getClosePair(i).second;
+ // pairs are processed in blocks: distances are first collected and then
+ // pbc is applied to the whole block at once, avoiding a dispatch per pair
+ const unsigned nblock=512;
+ ArenaVector<Vector>::type distances(nblock);
+ ArenaVector<unsigned>::type index0(nblock),index1(nblock);
+
+ unsigned int i=rank;
+ while(i<nl->size()) {                   // sum over close pairs
+  unsigned nb=0;
+  for(;i<nl->size() && nb<nblock;i+=stride){
+   unsigned i0=nl->getClosePair(i).first;
+   unsigned i1=nl->getClosePair(i).second;
+   if(getAbsoluteIndex(i0)==getAbsoluteIndex(i1)) continue;
+   index0[nb]=i0;
+   index1[nb]=i1;
+   distances[nb]=delta(getPosition(i0),getPosition(i1));
+   nb++;
+  }
 
-  if(getAbsoluteIndex(i0)==getAbsoluteIndex(i1)) continue;
+  if(pbc && nb>0) getPbc().apply(&distances[0],nb);
 
-  if(pbc){
-   distance=pbcDistance(getPosition(i0),getPosition(i1));
-  } else {
-   distance=delta(getPosition(i0),getPosition(i1));
-  }
+  for(unsigned k=0;k<nb;k++){
+   const Vector & distance(distances[k]);
+   unsigned i0=index0[k];
+   unsigned i1=index1[k];
 
-  double dfunc=0.;
-  ncoord += pairing(distance.modulo2(), dfunc,i0,i1);
+   double dfunc=0.;
+   ncoord += pairing(distance.modulo2(), dfunc,i0,i1);
 
-  deriv[i0] = deriv[i0] + (-dfunc)*distance ;
-  deriv[i1] = deriv[i1] + dfunc*distance ;
-  virial=virial+(-dfunc)*Tensor(distance,distance);
+   deriv[i0] = deriv[i0] + (-dfunc)*distance ;
+   deriv[i1] = deriv[i1] + dfunc*distance ;
+   virial=virial+(-dfunc)*Tensor(distance,distance);
+  }
  }
 
  if(!serial){
@@ -35,6 +35,9 @@ class CoordinationBase : public Colvar {
   NeighborList *nl;
   bool invalidateList;
   bool firsttime;
+/// The neighbor list is rebuilt only when atoms moved by more than half the skin
+  bool adaptive;
+  double nl_cut;
   
 public:
   CoordinationBase(const ActionOptions&);
@@ -42,7 +45,10 @@ public:
 // active methods:
   virtual void calculate();
   virtual void prepare();
+  virtual void checkEvaluationStride();
   virtual double pairing(double distance,double&dfunc,unsigned i,unsigned j)const=0;
+/// Distance beyond which pairing() is exactly zero (needed by NL_ADAPTIVE)
+  virtual double getPairingCutoff()const;
   static void registerKeywords( Keywords& keys );
 };
 
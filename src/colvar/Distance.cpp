@@ -191,10 +191,11 @@ void Distance::calculate(){
   const double value=distance.modulo();
   const double invvalue=1.0/value;
 
+// components are retrieved by index: they have been added in the order x,y,z (or a,b,c) in the constructor
   if(components){
-    Value* valuex=getPntrToComponent("x");
-    Value* valuey=getPntrToComponent("y");
-    Value* valuez=getPntrToComponent("z");
+    Value* valuex=getPntrToComponent(0);
+    Value* valuey=getPntrToComponent(1);
+    Value* valuez=getPntrToComponent(2);
 
     setAtomsDerivatives (valuex,0,Vector(-1,0,0));
     setAtomsDerivatives (valuex,1,Vector(+1,0,0));
@@ -211,9 +212,9 @@ void Distance::calculate(){
     setBoxDerivatives   (valuez,Tensor(distance,Vector(0,0,-1)));
     valuez->set(distance[2]);
   } else if(scaled_components){
-    Value* valuea=getPntrToComponent("a");
-    Value* valueb=getPntrToComponent("b");
-    Value* valuec=getPntrToComponent("c");
+    Value* valuea=getPntrToComponent(0);
+    Value* valueb=getPntrToComponent(1);
+    Value* valuec=getPntrToComponent(2);
     Vector d=getPbc().realToScaled(distance);
     setAtomsDerivatives (valuea,0,matmul(getPbc().getInvBox(),Vector(-1,0,0)));
     setAtomsDerivatives (valuea,1,matmul(getPbc().getInvBox(),Vector(+1,0,0)));
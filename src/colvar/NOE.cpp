@@ -78,11 +78,21 @@ private:
   bool             isupper;
   bool             ensemble;
   bool             serial;
+/// Work arrays shared by the two phases of the calculation
+  vector<double>   noe, dnoe;
+  vector<Vector>   deriv;
+  double           score;
+/// Pending ensemble average among replicas
+  Communicator::Request ensreq;
+/// Calculate the local NOEs and start the ensemble average
+  void calculateLocal();
 public:
   static void registerKeywords( Keywords& keys );
   NOE(const ActionOptions&);
   ~NOE();
   virtual void calculate();
+  virtual bool startCalculation();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(NOE,"NOE")
@@ -196,11 +206,22 @@ NOE::~NOE(){
 } 
 
 void NOE::calculate(){ 
-  Tensor virial;
-  double score=0.;
-  std::vector<Vector> deriv(getNumberOfAtoms());
-  vector<double> noe(nga.size());
-  vector<double> dnoe(nga.size());
+  calculateLocal();
+  finishCalculation();
+}
+
+bool NOE::startCalculation(){
+  // only the ensemble average can overlap with other actions
+  if(!ensemble) return false;
+  calculateLocal();
+  return true;
+}
+
+void NOE::calculateLocal(){
+  score=0.;
+  deriv.assign(getNumberOfAtoms(),Vector());
+  noe.resize(nga.size());
+  dnoe.resize(nga.size());
  
   // internal parallelisation
   unsigned stride=comm.Get_size();
@@ -270,15 +291,32 @@ void NOE::calculate(){
   }
 
   // Ensemble averaging
-  double fact=1.0;
   if(ensemble) {
-    fact = 1./((double) ens_dim);
     // share the calculated noe
     if(!serial) comm.Sum(&noe[0],noe.size());
     // I am the master of my replica
     if(comm.Get_rank()==0) {
       // among replicas
-      multi_sim_comm.Sum(&noe[0], nga.size() );
+      ensreq=multi_sim_comm.Isum(&noe[0], nga.size() );
+    }
+  }
+}
+
+void NOE::finishCalculation(){
+  Tensor virial;
+
+  unsigned stride=comm.Get_size();
+  unsigned rank=comm.Get_rank();
+  if(serial){
+    stride=1;
+    rank=0;
+  }
+
+  double fact=1.0;
+  if(ensemble) {
+    fact = 1./((double) ens_dim);
+    if(comm.Get_rank()==0) {
+      ensreq.wait();
       for(unsigned i=0;i<nga.size();i++) noe[i] *= fact; 
     } else for(unsigned i=0;i<nga.size();i++) noe[i] = 0.;
     // inside each replica
@@ -293,7 +331,7 @@ void NOE::calculate(){
     }
   }
 
-  index=0; for(unsigned k=0;k<rank;k++) index += nga[k];
+  unsigned index=0; for(unsigned k=0;k<rank;k++) index += nga[k];
 
   for(unsigned i=rank;i<nga.size();i+=stride) { //cycle over the number of groups
     for(unsigned j=0;j<nga[i];j++) {
@@ -28,6 +28,8 @@
 #include "tools/PDB.h"
 #include "tools/RMSD.h"
 #include "tools/Tools.h"
+#include "tools/Arena.h"
+#include <exception>
 
 using namespace std;
 
@@ -40,15 +42,55 @@ void PathMSDBase::registerKeywords(Keywords& keys){
   keys.add("compulsory","REFERENCE","the pdb is needed to provide the various milestones");
   keys.add("optional","NEIGH_SIZE","size of the neighbor list");
   keys.add("optional","NEIGH_STRIDE","how often the neighbor list needs to be calculated in time units");
+  keys.add("compulsory","NUM_THREADS","1","the number of threads computing the distances from the frames on each process");
 }
 
+class PathMSDBase::ThreadTask {
+public:
+  PathMSDBase* action;
+  unsigned thread;
+/// frames first, first+stride, ... are handled by this thread. They are set by the
+/// calling thread, since MPI might not be usable from the other ones
+  unsigned first,stride;
+  double* distances;
+  Vector* accumulators;
+  const double* center;
+/// error raised by the thread, reported after all the threads have finished
+  std::string error;
+};
+
 PathMSDBase::PathMSDBase(const ActionOptions&ao):
 PLUMED_COLVAR_INIT(ao),
 neigh_size(-1),
 neigh_stride(-1),
+val_z_path(NULL),
+nthreads(1),
+#ifdef __PLUMED_HAS_PTHREAD
+generation(0),
+pending(0),
+stop(false),
+#endif
 nframes(0)
 {
   parse("LAMBDA",lambda);
+  parse("NUM_THREADS",nthreads);
+  if(nthreads==0) error("NUM_THREADS should be at least one");
+#ifndef __PLUMED_HAS_PTHREAD
+  if(nthreads>1){
+    log.printf("  WARNING: plumed was compiled without pthread, NUM_THREADS is ignored\n");
+    nthreads=1;
+  }
+#endif
+  tmp_derivs.resize(nthreads);
+  for(unsigned t=0;t<nthreads;t++){
+    tasks.push_back(new ThreadTask);
+    tasks[t]->action=this;
+    tasks[t]->thread=t;
+  }
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_mutex_init(&mutex,NULL);
+  pthread_cond_init(&cond,NULL);
+#endif
   parse("NEIGH_SIZE",neigh_size);
   parse("NEIGH_STRIDE",neigh_stride);
   parse("REFERENCE",reference);
@@ -97,9 +139,91 @@ nframes(0)
   }else{
            log.printf("  Neighbor list NOT enabled \n");
   }
+  if(nthreads>1) log.printf("  Distances from the frames computed by %u threads on each process\n",nthreads);
+
+}
+
+PathMSDBase::~PathMSDBase(){
+#ifdef __PLUMED_HAS_PTHREAD
+  stopThreads();
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+#endif
+  for(unsigned t=0;t<tasks.size();t++) delete tasks[t];
+}
+
+void PathMSDBase::checkEvaluationStride(){
+  if(neigh_size>0) checkPeriod("NEIGH_STRIDE",neigh_stride);
+}
+
+void PathMSDBase::calculateFrames(unsigned thread,unsigned first,unsigned stride,double* distances,Vector* accumulators,const double* center){
+  unsigned nat=pdbv[0].size();
+  unsigned ncomp=val_s_path.size();
+  std::vector<Vector>& derivs(tmp_derivs[thread]);
+  for(unsigned i=first;i<imgVec.size();i+=stride){
+    distances[i]=msdv[imgVec[i].index].calculate(getPositions(),derivs,true);
+    plumed_assert(derivs.size()==nat);
+    double expval=exp(-lambda*distances[i]);
+    for(unsigned k=0;k<nat;k++) accumulators[k]+=expval*derivs[k];
+    for(unsigned j=0;j<ncomp;j++){
+      double w=expval*(imgVec[i].property[j]-center[j]);
+      Vector* acc=accumulators+(j+1)*nat;
+      for(unsigned k=0;k<nat;k++) acc[k]+=w*derivs[k];
+    }
+  }
+}
+
+void PathMSDBase::runThread(ThreadTask* task){
+  try{
+    task->action->calculateFrames(task->thread,task->first,task->stride,task->distances,task->accumulators,task->center);
+  } catch(std::exception& e){
+    task->error=e.what();
+  } catch(...){
+// nothing should escape from a thread
+    task->error="unknown exception while computing the distances from the frames";
+  }
+}
 
+#ifdef __PLUMED_HAS_PTHREAD
+void PathMSDBase::startThreads(){
+// thread 0 is the calling thread
+  threads.resize(nthreads);
+  started.assign(nthreads,false);
+  for(unsigned t=1;t<nthreads;t++) started[t]=(pthread_create(&threads[t],NULL,runWorker,tasks[t])==0);
 }
 
+void PathMSDBase::stopThreads(){
+  pthread_mutex_lock(&mutex);
+  stop=true;
+  pthread_cond_broadcast(&cond);
+  pthread_mutex_unlock(&mutex);
+  for(unsigned t=1;t<started.size();t++) if(started[t]) pthread_join(threads[t],NULL);
+  started.clear();
+}
+
+void* PathMSDBase::runWorker(void*p){
+  ThreadTask* task=static_cast<ThreadTask*>(p);
+  task->action->work(task->thread);
+  return NULL;
+}
+
+void PathMSDBase::work(unsigned thread){
+  unsigned long done=0;
+  pthread_mutex_lock(&mutex);
+  while(true){
+    while(!stop && generation==done) pthread_cond_wait(&cond,&mutex);
+    if(stop) break;
+    done=generation;
+    pthread_mutex_unlock(&mutex);
+    runThread(tasks[thread]);
+    pthread_mutex_lock(&mutex);
+    pending--;
+    if(pending==0) pthread_cond_broadcast(&cond);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+#endif
+
 void PathMSDBase::calculate(){
 
   if(neigh_size>0 && getExchangeStep()) error("Neighbor lists for this collective variable are not compatible with replica exchange, sorry for that!");
@@ -116,51 +240,74 @@ void PathMSDBase::calculate(){
       }
   }
 
+  if(!val_z_path){
+    if(labels.size()>0){
+      for(unsigned i=0;i<labels.size();i++){ val_s_path.push_back(getPntrToComponent(labels[i].c_str()));}
+    }else{
+       val_s_path.push_back(getPntrToComponent("sss"));
+    } 
+    val_z_path=getPntrToComponent("zzz");
+  }
+
 // THIS IS THE HEAVY PART (RMSD STUFF)
-  unsigned stride=comm.Get_size();
-  unsigned rank=comm.Get_rank();
   unsigned nat=pdbv[0].size();
+  unsigned ncomp=val_s_path.size();
   plumed_assert(nat>0);
   plumed_assert(nframes>0);
   plumed_assert(imgVec.size()>0);
 
-  std::vector<double> tmp_distances(imgVec.size(),0.0);
-  std::vector<Vector> tmp_derivs;
-// this array is a merge of all tmp_derivs, so as to allow a single comm.Sum below
-  std::vector<Vector> tmp_derivs2(imgVec.size()*nat);
-
-// if imgVec.size() is less than nframes, it means that only some msd will be calculated
-  for(unsigned i=rank;i<imgVec.size();i+=stride){
-// store temporary local results
-    tmp_distances[i]=msdv[imgVec[i].index].calculate(getPositions(),tmp_derivs,true);
-    plumed_assert(tmp_derivs.size()==nat);
-    for(unsigned j=0;j<nat;j++) tmp_derivs2[i*nat+j]=tmp_derivs[j];
+// The derivatives of s and z are contracted on each process and thread with
+//   dz/dx     = sum_i e_i d_i/partition
+//   ds_j/dx   = lambda/partition * ( (s_j-c_j) sum_i e_i d_i - sum_i e_i (p_ij-c_j) d_i )
+// where e_i is the similarity of frame i, d_i the derivative of its distance and p_ij its properties.
+// Only these sums, and not the derivatives of every frame, have to be reduced.
+// c_j is the average property, which is subtracted to avoid cancellations.
+  ArenaVector<double>::type center(ncomp,0.0);
+  for(unsigned i=0;i<imgVec.size();i++) for(unsigned j=0;j<ncomp;j++) center[j]+=imgVec[i].property[j];
+  for(unsigned j=0;j<ncomp;j++) center[j]/=imgVec.size();
+
+  unsigned block=(ncomp+1)*nat;
+  ArenaVector<double>::type tmp_distances(imgVec.size(),0.0);
+// one set of sums per thread, merged in the first one
+  ArenaVector<Vector>::type accumulators(nthreads*block);
+  unsigned rank=comm.Get_rank(), nprocs=comm.Get_size();
+  for(unsigned t=0;t<nthreads;t++){
+    tasks[t]->first=rank+nprocs*t;
+    tasks[t]->stride=nprocs*nthreads;
+    tasks[t]->distances=&tmp_distances[0];
+    tasks[t]->accumulators=&accumulators[t*block];
+    tasks[t]->center=(ncomp>0?&center[0]:NULL);
+    tasks[t]->error="";
   }
+#ifdef __PLUMED_HAS_PTHREAD
+  if(started.size()==0) startThreads();
+  unsigned nstarted=0;
+  for(unsigned t=0;t<nthreads;t++) if(started[t]) nstarted++;
+// the tasks are published to the waiting threads by the mutex
+  pthread_mutex_lock(&mutex);
+  pending=nstarted;
+  generation++;
+  pthread_cond_broadcast(&cond);
+  pthread_mutex_unlock(&mutex);
+// threads that could not be started are run here
+  for(unsigned t=0;t<nthreads;t++) if(!started[t]) runThread(tasks[t]);
+  pthread_mutex_lock(&mutex);
+  while(pending>0) pthread_cond_wait(&cond,&mutex);
+  pthread_mutex_unlock(&mutex);
+#else
+  runThread(tasks[0]);
+#endif
+  for(unsigned t=0;t<nthreads;t++) if(tasks[t]->error.length()>0) plumed_merror(tasks[t]->error);
+  for(unsigned t=1;t<nthreads;t++) for(unsigned k=0;k<block;k++) accumulators[k]+=accumulators[t*block+k];
 // reduce over all processors
   comm.Sum(tmp_distances);
-  comm.Sum(tmp_derivs2);
-// assign imgVec[i].distance and imgVec[i].distder
-  for(unsigned i=0;i<imgVec.size();i++){
-    imgVec[i].distance=tmp_distances[i];
-    imgVec[i].distder.assign(&tmp_derivs2[i*nat],nat+&tmp_derivs2[i*nat]);
-  }
+  comm.Sum(&accumulators[0],block);
+  for(unsigned i=0;i<imgVec.size();i++) imgVec[i].distance=tmp_distances[i];
 
 // END OF THE HEAVY PART
 
-  vector<Value*> val_s_path;
-  if(labels.size()>0){
-    for(unsigned i=0;i<labels.size();i++){ val_s_path.push_back(getPntrToComponent(labels[i].c_str()));}
-  }else{
-     val_s_path.push_back(getPntrToComponent("sss"));
-  } 
-  Value* val_z_path=getPntrToComponent("zzz");
-
-  vector<double> s_path(val_s_path.size());for(unsigned i=0;i<s_path.size();i++)s_path[i]=0.;
+  ArenaVector<double>::type s_path(ncomp,0.0);
   double partition=0.;
-  double tmp;
-
-  // clean vector
-  for(unsigned i=0;i< derivs_z.size();i++){derivs_z[i].zero();}
 
   typedef  vector< class ImagePath  >::iterator imgiter;
   for(imgiter it=imgVec.begin();it!=imgVec.end();++it){ 
@@ -173,19 +320,17 @@ void PathMSDBase::calculate(){
   }
   for(unsigned i=0;i<s_path.size();i++){ s_path[i]/=partition;  val_s_path[i]->set(s_path[i]) ;}
   val_z_path->set(-(1./lambda)*std::log(partition));
+  for(unsigned i=0;i< derivs_z.size();i++){
+    derivs_z[i]=accumulators[i]/partition;
+    setAtomsDerivatives (val_z_path,i,derivs_z[i]);
+  }
   for(unsigned j=0;j<s_path.size();j++){
-    // clean up
-    for(unsigned i=0;i< derivs_s.size();i++){derivs_s[i].zero();}
-    // do the derivative 
-    for(imgiter it=imgVec.begin();it!=imgVec.end();++it){ 
-       double expval=(*it).similarity;
-       tmp=lambda*expval*(s_path[j]-(*it).property[j])/partition;
-       for(unsigned i=0;i< derivs_s.size();i++){ derivs_s[i]+=tmp*(*it).distder[i] ;} 
-       if(j==0){for(unsigned i=0;i< derivs_z.size();i++){ derivs_z[i]+=(*it).distder[i]*expval/partition;}} 
-    }
+    double a=lambda*(s_path[j]-center[j])/partition;
+    double b=lambda/partition;
+    const Vector* acc=&accumulators[(j+1)*nat];
     for(unsigned i=0;i< derivs_s.size();i++){
-          setAtomsDerivatives (val_s_path[j],i,derivs_s[i]); 
-          if(j==0){setAtomsDerivatives (val_z_path,i,derivs_z[i]);} 
+      derivs_s[i]=a*accumulators[i]-b*acc[i];
+      setAtomsDerivatives (val_s_path[j],i,derivs_s[i]); 
     }
   }
   for(unsigned i=0;i<val_s_path.size();++i) setBoxDerivativesNoPbc(val_s_path[i]);
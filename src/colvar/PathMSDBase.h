@@ -24,6 +24,10 @@
 
 #include <cmath>
 
+#ifdef __PLUMED_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
 #include "Colvar.h"
 #include "ActionRegister.h"
 
@@ -46,8 +50,6 @@ class PathMSDBase : public Colvar {
         double distance;
         // similarity (exp - lambda distance) or other
         double similarity;
-        // derivatives of the distance
-        std::vector<Vector> distder;
         // here one can add a pointer to a value (hypothetically providing a distance from a point) 
   };
   struct imgOrderByDist {
@@ -69,6 +71,41 @@ class PathMSDBase : public Colvar {
   std::vector<Vector> derivs_s;
   std::vector<Vector> derivs_z;
   std::vector <ImagePath> imgVec; // this can be used for doing neighlist   
+/// the components, which are added by the derived classes and looked up at the first step
+  std::vector<Value*> val_s_path;
+  Value* val_z_path;
+/// number of threads computing the distances from the frames on each process
+  unsigned nthreads;
+/// derivatives of the distance from the current frame, one array per thread
+  std::vector< std::vector<Vector> > tmp_derivs;
+/// work assigned to a thread
+  class ThreadTask;
+/// the work of each thread at the current step
+  std::vector<ThreadTask*> tasks;
+#ifdef __PLUMED_HAS_PTHREAD
+/// The threads are started at the first step and wait for work until the action is destroyed,
+/// so as not to pay for their creation at every step
+  std::vector<pthread_t> threads;
+/// tells which threads have been started; the work of the others is done by the calling thread
+  std::vector<bool> started;
+  pthread_mutex_t mutex;
+/// signals new work and the end of the work
+  pthread_cond_t cond;
+/// incremented every time new work is available
+  unsigned long generation;
+/// number of threads that are still working at the current step
+  unsigned pending;
+  bool stop;
+  void startThreads();
+  void stopThreads();
+/// wait for work and do it, until stop is set
+  void work(unsigned thread);
+  static void* runWorker(void*);
+#endif
+/// Compute the distances from the frames handled by one thread and accumulate
+/// the derivatives weighted by the similarity of each frame, see calculate()
+  void calculateFrames(unsigned thread,unsigned first,unsigned stride,double* distances,Vector* accumulators,const double* center);
+  static void runThread(ThreadTask*);
 protected:
   std::vector<PDB> pdbv;
   std::vector<std::string> labels;
@@ -76,9 +113,11 @@ protected:
   unsigned nframes;
 public:
   PathMSDBase(const ActionOptions&);
+  ~PathMSDBase();
 // active methods:
   virtual void calculate();
 //  virtual void prepare();
+  virtual void checkEvaluationStride();
   static void registerKeywords(Keywords& keys);
 };
 
@@ -136,10 +136,11 @@ void Position::calculate(){
     distance=delta(Vector(0.0,0.0,0.0),getPosition(0));
   }
 
+// components are retrieved by index: they have been added in the order a,b,c (or x,y,z) in the constructor
   if(scaled_components){
-    Value* valuea=getPntrToComponent("a");
-    Value* valueb=getPntrToComponent("b");
-    Value* valuec=getPntrToComponent("c");
+    Value* valuea=getPntrToComponent(0);
+    Value* valueb=getPntrToComponent(1);
+    Value* valuec=getPntrToComponent(2);
     Vector d=getPbc().realToScaled(distance);
     setAtomsDerivatives (valuea,0,matmul(getPbc().getInvBox(),Vector(+1,0,0)));
     valuea->set(Tools::pbc(d[0]));
@@ -148,9 +149,9 @@ void Position::calculate(){
     setAtomsDerivatives (valuec,0,matmul(getPbc().getInvBox(),Vector(0,0,+1)));
     valuec->set(Tools::pbc(d[2]));
   } else {
-    Value* valuex=getPntrToComponent("x");
-    Value* valuey=getPntrToComponent("y");
-    Value* valuez=getPntrToComponent("z");
+    Value* valuex=getPntrToComponent(0);
+    Value* valuey=getPntrToComponent(1);
+    Value* valuez=getPntrToComponent(2);
 
     setAtomsDerivatives (valuex,0,Vector(+1,0,0));
     setBoxDerivatives   (valuex,Tensor(distance,Vector(-1,0,0)));
@@ -128,10 +128,21 @@ private:
   bool correlation;
   bool serial;
   bool svd;
+/// Work arrays shared by the two phases of the calculation
+  vector<double> rdc;
+  vector<Vector> dRDC;
+  double score;
+  double scx, scx2, scy, scxy;
+/// Pending ensemble average among replicas
+  Communicator::Request ensreq;
+/// Calculate the local RDCs and start the ensemble average
+  void calculateLocal();
 public:
   RDC(const ActionOptions&);
   static void registerKeywords( Keywords& keys );
   virtual void calculate();
+  virtual bool startCalculation();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(RDC,"RDC")
@@ -268,11 +279,25 @@ firstTime(true)
 
 void RDC::calculate()
 {
-  double score=0.;
-  double scx=0., scx2=0., scy=0., scxy=0.;
-  vector<double> rdc( coupl.size() );
+  calculateLocal();
+  finishCalculation();
+}
+
+bool RDC::startCalculation()
+{
+  // only the ensemble average can overlap with other actions
+  if(!ensemble) return false;
+  calculateLocal();
+  return true;
+}
+
+void RDC::calculateLocal()
+{
+  score=0.;
+  scx=0.; scx2=0.; scy=0.; scxy=0.;
+  rdc.assign( coupl.size(), 0. );
   unsigned N = getNumberOfAtoms();
-  vector<Vector> dRDC(N);
+  dRDC.assign(N,Vector());
 
   // internal parallelisation
   unsigned stride=2*comm.Get_size();
@@ -466,15 +491,34 @@ void RDC::calculate()
   }
 
   // Ensemble averaging
-  double fact=1.0;
   if(ensemble) {
-    fact = 1./((double) ens_dim);
     // share the calculated rdc
     if(!serial) comm.Sum(&rdc[0],rdc.size());
     // I am the master of my replica
     if(comm.Get_rank()==0) {
       // among replicas
-      multi_sim_comm.Sum(&rdc[0], coupl.size() );
+      ensreq=multi_sim_comm.Isum(&rdc[0], coupl.size() );
+    }
+  }
+}
+
+void RDC::finishCalculation()
+{
+  unsigned N = getNumberOfAtoms();
+
+  // internal parallelisation
+  unsigned stride=2*comm.Get_size();
+  unsigned rank=2*comm.Get_rank();
+  if(serial){
+    stride=2;
+    rank=0;
+  }
+
+  double fact=1.0;
+  if(ensemble) {
+    fact = 1./((double) ens_dim);
+    if(comm.Get_rank()==0) {
+      ensreq.wait();
       for(unsigned i=0;i<coupl.size();i++) rdc[i] *= fact; 
     } else for(unsigned i=0;i<coupl.size();i++) rdc[i] = 0.;
     // inside each replica
@@ -132,6 +132,29 @@ void Action::addDependency(Action*action){
   after.push_back(action);
 }
 
+void Action::setEvaluationStrides(const std::set<int>& s){
+  evaluationStrides=s;
+  checkEvaluationStride();
+}
+
+const std::set<int> & Action::getEvaluationStrides()const{
+  return evaluationStrides;
+}
+
+void Action::checkPeriod(const std::string& key,int period)const{
+  if(period<=0 || evaluationStrides.empty()) return;
+// the steps which are multiples of period are all evaluation steps only if period is a multiple of one of the strides
+  std::string s;
+  for(std::set<int>::const_iterator i=evaluationStrides.begin();i!=evaluationStrides.end();++i){
+    if(period%(*i)==0) return;
+    std::string n; Tools::convert(*i,n);
+    s+=(s.length()>0?",":"")+n;
+  }
+  std::string p;
+  Tools::convert(period,p);
+  error(key+"="+p+" is not a multiple of any of the strides with which "+label+" is evaluated ("+s+"), so the task would be skipped on some steps");
+}
+
 void Action::activate(){
 // preparation step is called only the first time an Action is activated.
 // since it could change its dependences (e.g. in an ActionAtomistic which is
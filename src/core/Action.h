@@ -92,6 +92,10 @@ private:
 /// Switch to activate Action on this step.
   bool active;
 
+/// Strides of the PLMD::ActionPilot objects which cause this Action to be evaluated
+/// (empty if it is never evaluated).
+  std::set<int> evaluationStrides;
+
 /// Option that you might have enabled 
   std::set<std::string> options; 
 
@@ -188,6 +192,18 @@ public:
 /// The set of all Actions is calculated in forward order.
   virtual void calculate()=0;
 
+/// Start a split calculation.
+/// Actions that need a reduction among replicas can override this to do
+/// their local work and post a non-blocking reduction (see Communicator::Isum).
+/// If it returns true, finishCalculation() is called later in the forward loop,
+/// just before the first action that depends on this one, so that independent
+/// actions are calculated while the reduction is in flight.
+/// If it returns false (default) nothing has been done and calculate() is used instead.
+  virtual bool startCalculation(){return false;}
+
+/// Complete a calculation started with startCalculation().
+  virtual void finishCalculation(){}
+
 /// Apply an Action.
 /// This method is called one time per step.
 /// The set of all Actions is applied in backward order.
@@ -234,6 +250,24 @@ public:
 /// Return dependencies
   const Dependencies & getDependencies()const{return after;}
 
+/// Set the strides with which this Action is evaluated.
+/// These are the strides of all the PLMD::ActionPilot objects which depend on it,
+/// so that the Action is evaluated on the steps which are multiples of at least one of them.
+/// They are set by PlumedMain each time the list of Action's changes. checkEvaluationStride() is then called.
+  void setEvaluationStrides(const std::set<int>&);
+
+/// Return the strides with which this Action is evaluated (empty if it is never evaluated)
+  const std::set<int> & getEvaluationStrides()const;
+
+/// Check that the tasks done periodically by this Action are compatible with
+/// its evaluation strides. Actions which perform something every n steps
+/// (e.g. updating a neighbor list) should check this here with checkPeriod()
+  virtual void checkEvaluationStride(){}
+
+/// Stop with an error if a task done every period steps, set with keyword key,
+/// would be skipped because the Action is not evaluated on those steps
+  void checkPeriod(const std::string& key,int period)const;
+
 /// Check if numerical derivatives should be performed
   virtual bool checkNumericalDerivatives()const{return false;}
 
@@ -70,6 +70,7 @@ void ActionAtomistic::requestAtoms(const vector<AtomNumber> & a){
   int n=atoms.positions.size();
   clearDependencies();
   unique.clear();
+  atoms.invalidateUniqueList();
   for(unsigned i=0;i<indexes.size();i++){
     if(indexes[i].index()>=n) error("atom out of range");
     if(atoms.isVirtualAtom(indexes[i])) addDependency(atoms.getVirtualAtomsAction(indexes[i]));
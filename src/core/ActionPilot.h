@@ -40,9 +40,9 @@ class ActionPilot:
   public virtual Action
 {
   int stride; // multiple time step
-protected:
-  int getStride()const;
 public:
+/// Return the stride with which the action is run
+  int getStride()const;
   ActionPilot(const ActionOptions&);
 /// Create the keywords for actionPilot
   static void registerKeywords(Keywords& keys);
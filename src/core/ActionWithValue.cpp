@@ -54,7 +54,8 @@ void ActionWithValue::useCustomisableComponents(Keywords& keys){
 ActionWithValue::ActionWithValue(const ActionOptions&ao):
   Action(ao),
   noderiv(true),
-  numericalDerivatives(false)
+  numericalDerivatives(false),
+  biasComponent(NULL)
 {
   if( keywords.exists("NUMERICAL_DERIVATIVES") ) parseFlag("NUMERICAL_DERIVATIVES",numericalDerivatives);
   if(numericalDerivatives) log.printf("  using numerical derivatives\n");
@@ -138,6 +139,7 @@ void ActionWithValue::addComponent( const std::string& name ){
      plumed_massert(values[i]->name!=thename,"there is already a value with this name");
   }
   values.push_back(new Value(this,thename, false ) );
+  if( name=="bias" ) biasComponent=values.back();
   std::string msg="  added component to this action:  "+thename+" \n";
   log.printf(msg.c_str());
 }
@@ -154,15 +156,15 @@ void ActionWithValue::addComponentWithDerivatives( const std::string& name ){
      plumed_massert(values[i]->name!=thename,"there is already a value with this name");
   }
   values.push_back(new Value(this,thename, true ) );
+  if( name=="bias" ) biasComponent=values.back();
   std::string msg="  added component to this action:  "+thename+" \n";
   log.printf(msg.c_str());
 }
 
 int ActionWithValue::getComponent( const std::string& name ) const {
   plumed_massert( !exists( getLabel() ), "You should not be calling this routine if you are using a value");
-  std::string thename; thename=getLabel() + "." + name;
   for(unsigned i=0;i<values.size();++i){
-     if (values[i]->name==thename) return i;
+     if( isComponent( values[i], name ) ) return i;
   }
   plumed_merror("there is no component with name " + name);
   return -1;
@@ -193,7 +195,8 @@ void ActionWithValue::componentIsNotPeriodic( const std::string& name ){
 }
 
 void ActionWithValue::setGradientsIfNeeded(){
-  if(isOptionOn("GRADIENTS")) {
+  static const std::string gradients("GRADIENTS");
+  if(isOptionOn(gradients)) {
      for(unsigned i=0;i<values.size();i++) values[i]->setGradients();
   }
 }
@@ -72,8 +72,12 @@ private:
   bool noderiv;
 /// Are we using numerical derivatives to differentiate
   bool numericalDerivatives;
+/// The component called bias, NULL if there is no such component
+  Value* biasComponent;
 /// Return the index for the component named name
   int getComponent( const std::string& name ) const;
+/// Check if the value v is the component called name (i.e. if it is called label.name)
+  bool isComponent( const Value* v, const std::string& name ) const ;
 public:
 
 // -------- The action has one value only  ---------------- //
@@ -126,6 +130,9 @@ public:
   double getOutputQuantity( const unsigned j ) const ;
 /// Get the value with a specific name (N.B. if there is no such value this returns zero)
   double getOutputQuantity( const std::string& name ) const ; 
+/// Get a pointer to the component called bias (NULL if there is no such component).
+/// The pointer is stored when the component is added so this can be used at every step
+  Value* getPntrToBiasComponent() const ;
 
 //  --- Routines for passing stuff to ActionWithArguments -- //
 
@@ -177,13 +184,24 @@ double ActionWithValue::getOutputQuantity(const unsigned j) const {
 
 inline
 double ActionWithValue::getOutputQuantity( const std::string& name ) const {
-  std::string thename; thename=getLabel() + "." + name;
   for(unsigned i=0;i<values.size();++i){
-    if( values[i]->name==thename ) return values[i]->value;
+    if( isComponent( values[i], name ) ) return values[i]->value;
   }
   return 0.0;
 }
 
+inline
+Value* ActionWithValue::getPntrToBiasComponent() const {
+  return biasComponent;
+}
+
+inline
+bool ActionWithValue::isComponent( const Value* v, const std::string& name ) const {
+  const std::string& label(getLabel()); const std::string& vname(v->name);
+  return vname.length()==label.length()+1+name.length() && vname.compare(0,label.length(),label)==0 && 
+         vname[label.length()]=='.' && vname.compare(label.length()+1,name.length(),name)==0;
+}
+
 inline
 void ActionWithValue::setValue(const double& d){
   plumed_massert(values.size()==1, "cannot use setValue in multi-component actions");
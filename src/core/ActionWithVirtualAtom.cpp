@@ -34,7 +34,8 @@ void ActionWithVirtualAtom::registerKeywords(Keywords& keys){
 
 ActionWithVirtualAtom::ActionWithVirtualAtom(const ActionOptions&ao):
   Action(ao),
-  ActionAtomistic(ao)
+  ActionAtomistic(ao),
+  scalarDerivatives(false)
 {
   index=atoms.addVirtualAtom(this);
   log.printf("  serial associated to this virtual atom is %d\n",index.serial());
@@ -46,12 +47,18 @@ ActionWithVirtualAtom::~ActionWithVirtualAtom(){
 
 void ActionWithVirtualAtom::apply(){
   const Vector & f(atoms.forces[index.index()]);
-  for(unsigned i=0;i<getNumberOfAtoms();i++) modifyForces()[i]=matmul(derivatives[i],f);
+  std::vector<Vector> & forces(modifyForces());
+  if(scalarDerivatives){
+    for(unsigned i=0;i<getNumberOfAtoms();i++) forces[i]=weights[i]*f;
+  } else {
+    for(unsigned i=0;i<getNumberOfAtoms();i++) forces[i]=matmul(derivatives[i],f);
+  }
 }
 
 void ActionWithVirtualAtom::requestAtoms(const std::vector<AtomNumber> & a){
   ActionAtomistic::requestAtoms(a);
   derivatives.resize(a.size());
+  weights.resize(a.size());
 }
 
 void ActionWithVirtualAtom::setGradients(){
@@ -62,18 +69,21 @@ void ActionWithVirtualAtom::setGradients(){
     if(atoms.isVirtualAtom(an)){
       const ActionWithVirtualAtom* a=atoms.getVirtualAtomsAction(an);
       for(std::map<AtomNumber,Tensor>::const_iterator p=a->gradients.begin();p!=a->gradients.end();++p){
-        gradients[(*p).first]+=matmul(derivatives[i],(*p).second);
+        if(scalarDerivatives) gradients[(*p).first]+=weights[i]*(*p).second;
+        else gradients[(*p).first]+=matmul(derivatives[i],(*p).second);
       }
     // this case if the atom is a normal one 	 
     } else {
-      gradients[an]+=derivatives[i];
+      if(scalarDerivatives) gradients[an]+=weights[i]*Tensor::identity();
+      else gradients[an]+=derivatives[i];
     }
   }
 }
 
 
 void ActionWithVirtualAtom::setGradientsIfNeeded(){
-  if(isOptionOn("GRADIENTS")) { 
+  static const std::string gradients("GRADIENTS");
+  if(isOptionOn(gradients)) { 
 	setGradients() ;	
   }
 }
@@ -41,7 +41,11 @@ class ActionWithVirtualAtom:
   public ActionAtomistic
 {
   AtomNumber index;
+/// True if derivatives are stored as scalar weights (see setAtomWeight())
+  bool scalarDerivatives;
   std::vector<Tensor> derivatives;
+/// Compact form of derivatives, used when each of them is a multiple of the identity
+  std::vector<double> weights;
   std::map<AtomNumber,Tensor> gradients;
   void apply();
 protected:
@@ -55,6 +59,12 @@ protected:
   void requestAtoms(const std::vector<AtomNumber> & a);
 /// Set the derivatives of virtual atom coordinate wrt atoms on which it dependes
   void setAtomsDerivatives(const std::vector<Tensor> &d);
+/// Set the derivative of virtual atom coordinate wrt the i-th atom as w times the identity.
+/// This is the case for weighted averages (e.g. a center of mass) and it
+/// avoids storing and multiplying a full Tensor for each atom.
+/// Should be called for all the atoms, and not mixed with setAtomsDerivatives()
+/// in the same step.
+  void setAtomWeight(unsigned i,double w);
 public:
   void setGradients();
   const std::map<AtomNumber,Tensor> & getGradients()const;
@@ -88,9 +98,16 @@ void ActionWithVirtualAtom::setCharge(double c){
 
 inline
 void ActionWithVirtualAtom::setAtomsDerivatives(const std::vector<Tensor> &d){
+  scalarDerivatives=false;
   derivatives=d;
 }
 
+inline
+void ActionWithVirtualAtom::setAtomWeight(unsigned i,double w){
+  scalarDerivatives=true;
+  weights[i]=w;
+}
+
 inline
 const std::map<AtomNumber,Tensor> & ActionWithVirtualAtom::getGradients()const{
   return gradients;
@@ -56,7 +56,8 @@ Atoms::Atoms(PlumedMain&plumed):
   naturalUnits(false),
   timestep(0.0),
   forceOnEnergy(0.0),
-  kbT(0.0)
+  kbT(0.0),
+  uniqueListOK(false)
 {
   mdatoms=MDAtomsBase::create(sizeof(double));
 }
@@ -131,8 +132,26 @@ void Atoms::setForces(void*p,int i){
   mdatoms->setf(p,i); forcesHaveBeenSet++;
 }
 
+void Atoms::updateUniqueList(){
+  bool changed=!uniqueListOK || uniqueListActive.size()!=actions.size();
+  if(!changed) for(unsigned i=0;i<actions.size();i++) if(uniqueListActive[i]!=actions[i]->isActive()){
+    changed=true;
+    break;
+  }
+  if(!changed) return;
+  uniqueListActive.resize(actions.size());
+  uniqueList.clear();
+  for(unsigned i=0;i<actions.size();i++){
+    uniqueListActive[i]=actions[i]->isActive();
+    if(uniqueListActive[i])
+      uniqueList.insert(uniqueList.end(),actions[i]->getUnique().begin(),actions[i]->getUnique().end());
+  }
+  std::sort(uniqueList.begin(),uniqueList.end());
+  uniqueList.erase(std::unique(uniqueList.begin(),uniqueList.end()),uniqueList.end());
+  uniqueListOK=true;
+}
+
 void Atoms::share(){
-  std::set<AtomNumber> unique;
 // At first step I scatter all the atoms so as to store their mass and charge
 // Notice that this works with the assumption that charges and masses are
 // not changing during the simulation!
@@ -141,21 +160,21 @@ void Atoms::share(){
     return;
   }
   if(dd && int(gatindex.size())<natoms){
-    for(unsigned i=0;i<actions.size();i++) if(actions[i]->isActive()) {
-      unique.insert(actions[i]->getUnique().begin(),actions[i]->getUnique().end());
-    }
-  }
-  share(unique);
+    updateUniqueList();
+    share(uniqueList);
+  } else share(std::vector<AtomNumber>());
 }
 
 void Atoms::shareAll(){
-  std::set<AtomNumber> unique;
-  if(dd && int(gatindex.size())<natoms)
-    for(int i=0;i<natoms;i++) unique.insert(AtomNumber::index(i));
-  share(unique);
+  std::vector<AtomNumber> all;
+  if(dd && int(gatindex.size())<natoms){
+    all.resize(natoms);
+    for(int i=0;i<natoms;i++) all[i]=AtomNumber::index(i);
+  }
+  share(all);
 }
 
-void Atoms::share(const std::set<AtomNumber>& unique){
+void Atoms::share(const std::vector<AtomNumber>& unique){
   plumed_assert( positionsHaveBeenSet==3 && massesHaveBeenSet );
   mdatoms->getBox(box);
   mdatoms->getPositions(gatindex,positions);
@@ -169,52 +188,37 @@ void Atoms::share(const std::set<AtomNumber>& unique){
   if(dd && int(gatindex.size())<natoms){
     if(dd.async){
       for(unsigned i=0;i<dd.mpi_request_positions.size();i++) dd.mpi_request_positions[i].wait();
-      for(unsigned i=0;i<dd.mpi_request_index.size();i++)     dd.mpi_request_index[i].wait();
     }
+// index and data are packed in a single message
+    const int nrecord=ndata+1;
     int count=0;
-    for(std::set<AtomNumber>::const_iterator p=unique.begin();p!=unique.end();++p){
+    for(std::vector<AtomNumber>::const_iterator p=unique.begin();p!=unique.end();++p){
       if(dd.g2l[p->index()]>=0){
-        dd.indexToBeSent[count]=p->index();
-        dd.positionsToBeSent[ndata*count+0]=positions[p->index()][0];
-        dd.positionsToBeSent[ndata*count+1]=positions[p->index()][1];
-        dd.positionsToBeSent[ndata*count+2]=positions[p->index()][2];
+        double* record=&dd.positionsToBeSent[nrecord*count];
+        record[0]=p->index();
+        record[1]=positions[p->index()][0];
+        record[2]=positions[p->index()][1];
+        record[3]=positions[p->index()][2];
         if(!massAndChargeOK){
-          dd.positionsToBeSent[ndata*count+3]=masses[p->index()];
-          dd.positionsToBeSent[ndata*count+4]=charges[p->index()];
+          record[4]=masses[p->index()];
+          record[5]=charges[p->index()];
         }
         count++;
       }
     }
     if(dd.async){
+// every requested atom is owned by exactly one process, so that the receiver
+// knows how many atoms to expect and only processes owning some of them send
+      dd.nexpected=unique.size();
+      dd.tag=(dd.tag+1)%1000;
       dd.mpi_request_positions.resize(dd.Get_size());
-      dd.mpi_request_index.resize(dd.Get_size());
       for(int i=0;i<dd.Get_size();i++){
-        dd.mpi_request_index[i]=dd.Isend(&dd.indexToBeSent[0],count,i,666);
-        dd.mpi_request_positions[i]=dd.Isend(&dd.positionsToBeSent[0],ndata*count,i,667);
+        if(count>0) dd.mpi_request_positions[i]=dd.Isend(&dd.positionsToBeSent[0],nrecord*count,i,667+dd.tag);
+        else dd.mpi_request_positions[i]=Communicator::Request();
       }
     }else{
-      const int n=(dd.Get_size());
-      vector<int> counts(n);
-      vector<int> displ(n);
-      vector<int> counts5(n);
-      vector<int> displ5(n);
-      dd.Allgather(count,counts);
-      displ[0]=0;
-      for(int i=1;i<n;++i) displ[i]=displ[i-1]+counts[i-1];
-      for(int i=0;i<n;++i) counts5[i]=counts[i]*ndata;
-      for(int i=0;i<n;++i) displ5[i]=displ[i]*ndata;
-      dd.Allgatherv(&dd.indexToBeSent[0],count,&dd.indexToBeReceived[0],&counts[0],&displ[0]);
-      dd.Allgatherv(&dd.positionsToBeSent[0],ndata*count,&dd.positionsToBeReceived[0],&counts5[0],&displ5[0]);
-      int tot=displ[n-1]+counts[n-1];
-      for(int i=0;i<tot;i++){
-        positions[dd.indexToBeReceived[i]][0]=dd.positionsToBeReceived[ndata*i+0];
-        positions[dd.indexToBeReceived[i]][1]=dd.positionsToBeReceived[ndata*i+1];
-        positions[dd.indexToBeReceived[i]][2]=dd.positionsToBeReceived[ndata*i+2];
-        if(!massAndChargeOK){
-          masses[dd.indexToBeReceived[i]]      =dd.positionsToBeReceived[ndata*i+3];
-          charges[dd.indexToBeReceived[i]]     =dd.positionsToBeReceived[ndata*i+4];
-        }
-      }
+      dd.Allgatherv(&dd.positionsToBeSent[0],nrecord*count,&dd.positionsToBeReceived[0],dd.plan);
+      unpack(dd.plan.getTotal()/nrecord,ndata);
     }
   }
   virial.zero();
@@ -223,6 +227,21 @@ void Atoms::share(const std::set<AtomNumber>& unique){
   forceOnEnergy=0.0;
 }
 
+void Atoms::unpack(int n,int ndata){
+  const int nrecord=ndata+1;
+  for(int i=0;i<n;i++){
+    const double* record=&dd.positionsToBeReceived[nrecord*i];
+    const int index=int(record[0]);
+    positions[index][0]=record[1];
+    positions[index][1]=record[2];
+    positions[index][2]=record[3];
+    if(!massAndChargeOK){
+      masses[index] =record[4];
+      charges[index]=record[5];
+    }
+  }
+}
+
 void Atoms::wait(){
   dataCanBeSet=false; // Everything should be set by this stage
 // How many double per atom should be scattered
@@ -240,22 +259,14 @@ void Atoms::wait(){
 // receive toBeReceived
     Communicator::Status status;
     if(dd.async){
+      const int nrecord=ndata+1;
       int count=0;
-      for(int i=0;i<dd.Get_size();i++){
-        dd.Recv(&dd.indexToBeReceived[count],dd.indexToBeReceived.size()-count,i,666,status);
-        int c=status.Get_count<int>();
-        dd.Recv(&dd.positionsToBeReceived[ndata*count],dd.positionsToBeReceived.size()-ndata*count,i,667);
-        count+=c;
-      }
-      for(int i=0;i<count;i++){
-        positions[dd.indexToBeReceived[i]][0]=dd.positionsToBeReceived[ndata*i+0];
-        positions[dd.indexToBeReceived[i]][1]=dd.positionsToBeReceived[ndata*i+1];
-        positions[dd.indexToBeReceived[i]][2]=dd.positionsToBeReceived[ndata*i+2];
-        if(!massAndChargeOK){
-          masses[dd.indexToBeReceived[i]]      =dd.positionsToBeReceived[ndata*i+3];
-          charges[dd.indexToBeReceived[i]]     =dd.positionsToBeReceived[ndata*i+4];
-        }
+      while(count<dd.nexpected){
+        dd.Recv(&dd.positionsToBeReceived[nrecord*count],dd.positionsToBeReceived.size()-nrecord*count,Communicator::AnySource,667+dd.tag,status);
+        count+=status.Get_count<double>()/nrecord;
       }
+      plumed_assert(count==dd.nexpected);
+      unpack(count,ndata);
     }
     if(collectEnergy) dd.Sum(energy);
   }
@@ -290,12 +301,14 @@ void Atoms::setNatoms(int n){
 
 void Atoms::add(const ActionAtomistic*a){
   actions.push_back(a);
+  invalidateUniqueList();
 }
 
 void Atoms::remove(const ActionAtomistic*a){
   vector<const ActionAtomistic*>::iterator f=find(actions.begin(),actions.end(),a);
   plumed_massert(f!=actions.end(),"cannot remove an action registered to atoms");
   actions.erase(f);
+  invalidateUniqueList();
 }
 
 
@@ -309,10 +322,8 @@ void Atoms::setAtomsNlocal(int n){
   gatindex.resize(n);
   if(dd){
     dd.g2l.resize(natoms,-1);
-    dd.positionsToBeSent.resize(n*5,0.0);
-    dd.positionsToBeReceived.resize(natoms*5,0.0);
-    dd.indexToBeSent.resize(n,0);
-    dd.indexToBeReceived.resize(natoms,0);
+    dd.positionsToBeSent.resize(n*6,0.0);
+    dd.positionsToBeReceived.resize(natoms*6,0.0);
   };
 }
 
@@ -367,13 +378,10 @@ double Atoms::getKbT()const{
 
 
 void Atoms::createFullList(int*n){
-  vector<AtomNumber> fullListTmp;
-  for(unsigned i=0;i<actions.size();i++) if(actions[i]->isActive())
-    fullListTmp.insert(fullListTmp.end(),actions[i]->getUnique().begin(),actions[i]->getUnique().end());
-  std::sort(fullListTmp.begin(),fullListTmp.end());
-  int nn=std::unique(fullListTmp.begin(),fullListTmp.end())-fullListTmp.begin();
+  updateUniqueList();
+  int nn=uniqueList.size();
   fullList.resize(nn);
-  for(int i=0;i<nn;++i) fullList[i]=fullListTmp[i].index();
+  for(int i=0;i<nn;++i) fullList[i]=uniqueList[i].index();
   *n=nn;
 }
 
@@ -95,6 +95,17 @@ class Atoms
   std::vector<const ActionAtomistic*> actions;
   std::vector<int>    gatindex;
 
+/// Sorted list of the atoms requested by the active actions.
+/// It is rebuilt only when the requests or the set of active actions change.
+  std::vector<AtomNumber> uniqueList;
+/// Activity pattern of actions at the time uniqueList was built
+  std::vector<bool> uniqueListActive;
+  bool uniqueListOK;
+/// Mark uniqueList as out of date
+  void invalidateUniqueList(){uniqueListOK=false;}
+/// Rebuild uniqueList if needed
+  void updateUniqueList();
+
   class DomainDecomposition:
     public Communicator
   {
@@ -104,22 +115,29 @@ class Atoms
     std::vector<int>    g2l;
 
     std::vector<Communicator::Request> mpi_request_positions;
-    std::vector<Communicator::Request> mpi_request_index;
-    
+/// Persistent plan for the synchronous exchange
+    Communicator::AllgathervPlan plan;
+/// Number of atoms expected from the other processes in the asynchronous exchange
+    int nexpected;
+/// Tag used for the asynchronous exchange, changed at every step
+    int tag;
+
+/// Packed buffers, containing for each atom its index followed by
+/// positions (and masses and charges when needed)
     std::vector<double> positionsToBeSent;
     std::vector<double> positionsToBeReceived;
-    std::vector<int>    indexToBeSent;
-    std::vector<int>    indexToBeReceived;
     operator bool(){return on;}
     DomainDecomposition():
-      on(false), async(false)
+      on(false), async(false), nexpected(0), tag(0)
       {}
     void enable(Communicator& c);
   };
 
   DomainDecomposition dd;
 
-  void share(const std::set<AtomNumber>&);
+  void share(const std::vector<AtomNumber>&);
+/// Copy n packed records received from other processes into positions (and masses and charges)
+  void unpack(int n,int ndata);
 
 public:
 
@@ -28,6 +28,7 @@
 #include "ActionWithVirtualAtom.h"
 #include "Atoms.h"
 #include <set>
+#include <algorithm>
 #include "config/Config.h"
 #include <cstdlib>
 #include "ActionRegister.h"
@@ -40,6 +41,7 @@
 #include "tools/Communicator.h"
 #include "CLToolMain.h"
 #include "tools/Stopwatch.h"
+#include "tools/Arena.h"
 #include "tools/Citations.h"
 #include "ExchangePatterns.h"
 #include "tools/IFile.h"
@@ -64,6 +66,7 @@ PlumedMain::PlumedMain():
   active(false),
   atoms(*new Atoms(*this)),
   actionSet(*new ActionSet(*this)),
+  evaluationStridesChanged(false),
   bias(0.0),
   exchangePatterns(*new(ExchangePatterns)),
   exchangeStep(false),
@@ -136,7 +139,12 @@ PlumedMain::PlumedMain():
 PlumedMain::~PlumedMain(){
   stopwatch.start();
   stopwatch.stop();
-  if(initialized) log<<stopwatch;
+  if(initialized){
+    log<<stopwatch;
+    const Arena& arena(Arena::get());
+    log.printf("Temporary arrays: %lu allocations taken from the arena, which requested memory to the heap %lu times\n",
+               arena.getNumberOfAllocations(),arena.getNumberOfHeapAllocations());
+  }
   delete &exchangePatterns;
   delete &actionSet;
   delete &citations;
@@ -525,6 +533,7 @@ void PlumedMain::readInputWords(const std::vector<std::string> & words){
   };
 
   pilots=actionSet.select<ActionPilot*>();
+  evaluationStridesChanged=true;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -555,12 +564,20 @@ void PlumedMain::prepareDependencies(){
 
   stopwatch.start("1 Prepare dependencies");
 
+// temporaries of the previous step have all been released
+  Arena::get().reset();
+
 // activate all the actions which are on step
 // activation is recursive and enables also the dependencies
 // before doing that, the prepare() method is called to see if there is some
 // new/changed dependency (up to now, only useful for dependences on virtual atoms,
 // which can be dynamically changed).
 
+  if(evaluationStridesChanged){
+    setupEvaluationStrides();
+    evaluationStridesChanged=false;
+  }
+
 // First switch off all actions
   for(ActionSet::iterator p=actionSet.begin();p!=actionSet.end();++p){
      (*p)->deactivate();
@@ -586,6 +603,26 @@ void PlumedMain::prepareDependencies(){
   stopwatch.stop("1 Prepare dependencies");
 }
 
+void PlumedMain::setupEvaluationStrides(){
+// an Action is evaluated whenever one of the pilots which depend on it
+// (directly or through other Action's) is on step
+  std::map<Action*,std::set<int> > strides;
+  for(unsigned i=0;i<pilots.size();++i){
+    int stride=pilots[i]->getStride();
+    std::set<Action*> visited;
+    std::vector<Action*> stack(1,pilots[i]);
+    while(!stack.empty()){
+      Action* a=stack.back();
+      stack.pop_back();
+      if(!visited.insert(a).second) continue;
+      strides[a].insert(stride);
+      const Action::Dependencies & deps(a->getDependencies());
+      for(unsigned j=0;j<deps.size();++j) stack.push_back(deps[j]);
+    }
+  }
+  for(ActionSet::iterator p=actionSet.begin();p!=actionSet.end();++p) (*p)->setEvaluationStrides(strides[*p]);
+}
+
 void PlumedMain::shareData(){
 // atom positions are shared (but only if there is something to do)
   if(!active)return;
@@ -613,6 +650,8 @@ void PlumedMain::justCalculate(){
   bias=0.0;
 
   int iaction=0;
+// actions whose calculation has been started but not finished yet
+  std::vector<Action*> pending;
 // calculate the active actions in order (assuming *backward* dependence)
   for(ActionSet::iterator p=actionSet.begin();p!=actionSet.end();++p){
     std::string actionNumberLabel;
@@ -632,21 +671,49 @@ void PlumedMain::justCalculate(){
       if(aa) if(aa->isActive()) aa->retrieveAtoms();
     }
     if((*p)->isActive()){
+      // complete the split calculations this action depends on
+      const Action::Dependencies & deps((*p)->getDependencies());
+      for(unsigned i=0;i<pending.size();){
+        if(std::find(deps.begin(),deps.end(),pending[i])!=deps.end()){
+          pending[i]->finishCalculation();
+          collectCalculated(pending[i]);
+          pending.erase(pending.begin()+i);
+        } else i++;
+      }
+      bool split=false;
       if((*p)->checkNumericalDerivatives()) (*p)->calculateNumericalDerivatives();
+      else if((*p)->startCalculation()) split=true;
       else (*p)->calculate();
-      // This retrieves components called bias 
-      if(av) bias+=av->getOutputQuantity("bias");
-      if(av)av->setGradientsIfNeeded();	
-      ActionWithVirtualAtom*avv=dynamic_cast<ActionWithVirtualAtom*>(*p);
-      if(avv)avv->setGradientsIfNeeded();	
+      if(split) pending.push_back(*p);
+      else collectCalculated(*p);
     }
 
     if(detailedTimers) stopwatch.stop(actionNumberLabel);
     iaction++;
   }
+// complete the split calculations nobody depends on
+  for(unsigned i=0;i<pending.size();i++){
+    pending[i]->finishCalculation();
+    collectCalculated(pending[i]);
+  }
   stopwatch.stop("4 Calculating (forward loop)");
 }
 
+void PlumedMain::collectCalculated(Action*p){
+  ActionWithValue*av=dynamic_cast<ActionWithValue*>(p);
+  if(av){
+  // This retrieves components called bias 
+    Value* b=av->getPntrToBiasComponent();
+// a bias which is also calculated on the steps where it does not apply forces
+// (because other actions use its value) only contributes to the energy on its own steps
+    ActionPilot* ap=dynamic_cast<ActionPilot*>(p);
+    if(b && (!ap || ap->onStep())) bias+=b->get();
+    av->setGradientsIfNeeded();	
+  }
+  ActionWithVirtualAtom*avv=dynamic_cast<ActionWithVirtualAtom*>(p);
+  if(avv)avv->setGradientsIfNeeded();	
+}
+
 void PlumedMain::justApply(){
   
   if(!active)return;
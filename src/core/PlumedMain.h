@@ -50,6 +50,7 @@ namespace PLMD {
 
 
 
+class Action;
 class ActionAtomistic;
 class ActionPilot;
 class Log;
@@ -114,6 +115,12 @@ private:
 /// These are the action the, if they are Pilot::onStep(), can trigger execution
   std::vector<ActionPilot*> pilots;
 
+/// Set when Action's are added, so that evaluation strides are recomputed
+  bool evaluationStridesChanged;
+
+/// Compute the strides with which each Action is evaluated, see Action::setEvaluationStrides()
+  void setupEvaluationStrides();
+
 /// Suffix string for file opening, useful for multiple simulations in the same directory
   std::string suffix;
 
@@ -136,6 +143,9 @@ private:
   int* stopFlag;
   bool stopNow;
 
+/// Accumulate the bias and set the gradients of an action once its calculation is complete
+  void collectCalculated(Action*);
+
 public:
 /// Flag to switch off virial calculation (for debug and MD codes with no barostat)
   bool novirial;
@@ -43,18 +43,20 @@ private:
   int number_of_cluster;
 /// The values from the underlying colvar
   std::vector<double> myvals;
-/// The number of neighbors each atom has
-  std::vector<unsigned> nneigh;
-/// The adjacency list
-  Matrix<unsigned> adj_list;
+/// The adjacency lists in compressed sparse row format
+  std::vector<unsigned> offsets, neighbors;
 /// Vector that stores the sizes of the current set of clusters
   std::vector< std::pair<unsigned,unsigned> > cluster_sizes;
 /// Vector that identifies the cluster each atom belongs to
   std::vector<unsigned> which_cluster;
-/// The color that tells us whether a node has been visited
-  std::vector<unsigned> color;
-/// The recursive function at the heart of this method
-  int explore( const unsigned& index );
+/// The parent of each node in the union-find forest 
+  std::vector<unsigned> parent;
+/// The size of the tree rooted at each node in the union-find forest
+  std::vector<unsigned> treesize;
+/// Find the root of the tree containing index (with path compression)
+  unsigned findRoot( unsigned index );
+/// Join the trees containing i and j
+  void join( const unsigned& i, const unsigned& j );
 public:
 /// Create manual
   static void registerKeywords( Keywords& keys );
@@ -87,11 +89,10 @@ void DFSClustering::registerKeywords( Keywords& keys ){
 DFSClustering::DFSClustering(const ActionOptions&ao):
 Action(ao),
 AdjacencyMatrixAction(ao),
-nneigh(getFullNumberOfBaseTasks()),
-adj_list(getFullNumberOfBaseTasks(),getFullNumberOfBaseTasks()),
 cluster_sizes(getFullNumberOfBaseTasks()),
 which_cluster(getFullNumberOfBaseTasks()),
-color(getFullNumberOfBaseTasks())
+parent(getFullNumberOfBaseTasks()),
+treesize(getFullNumberOfBaseTasks())
 {
    if( getNumberOfBaseMultiColvars()!=1 ) error("should only be running DFS Clustering with one base multicolvar");
    // Find out which cluster we want
@@ -125,20 +126,28 @@ unsigned DFSClustering::getNumberOfQuantities(){
 
 void DFSClustering::completeCalculation(){
    // Get the adjacency matrix
-   retrieveAdjacencyLists( nneigh, adj_list ); 
-//   for(unsigned i=0;i<nneigh.size();++i){
-//       printf("ADJACENCY LIST FOR %d HAS %d MEMBERS : ",i,nneigh[i]);
-//       for(unsigned j=0;j<nneigh[i];++j) printf("%d ",adj_list(i,j) );
-//       printf("\n"); 
-//   }
+   retrieveAdjacencyLists( offsets, neighbors ); 
 
    // All the clusters have zero size initially
    for(unsigned i=0;i<cluster_sizes.size();++i){ cluster_sizes[i].first=0; cluster_sizes[i].second=i;}
 
-   // Perform clustering
-   number_of_cluster=-1; color.assign(color.size(),0);
+   // Perform clustering - every node starts in its own tree and trees are joined along edges
+   for(unsigned i=0;i<parent.size();++i){ parent[i]=i; treesize[i]=1; }
    for(unsigned i=0;i<getFullNumberOfBaseTasks();++i){
-      if( color[i]==0 ){ number_of_cluster++; color[i]=explore(i); } 
+      for(unsigned j=offsets[i];j<offsets[i+1];++j){
+          if( neighbors[j]>i ) join( i, neighbors[j] );
+      }
+   }
+
+   // Number the clusters in order of their lowest numbered atom.  This is the order
+   // in which they would be found by a depth first search started from each unvisited atom in turn
+   unsigned nnodes=getFullNumberOfBaseTasks(); number_of_cluster=-1; 
+   which_cluster.assign( nnodes, nnodes );
+   for(unsigned i=0;i<nnodes;++i){
+      unsigned root=findRoot(i);
+      if( which_cluster[root]==nnodes ){ number_of_cluster++; which_cluster[root]=number_of_cluster; }
+      which_cluster[i]=which_cluster[root];
+      cluster_sizes[which_cluster[i]].first++;
    }
 
    // Order the clusters in the system by size (this returns ascending order )
@@ -177,18 +186,23 @@ void DFSClustering::completeCalculation(){
    finishComputations();
 }
 
-int DFSClustering::explore( const unsigned& index ){
-
-   color[index]=1;
-   for(unsigned i=0;i<nneigh[index];++i){
-       unsigned j=adj_list(index,i);
-       if( color[j]==0 ) color[j]=explore(j);
+unsigned DFSClustering::findRoot( unsigned index ){
+   // Find the root
+   unsigned root=index;
+   while( parent[root]!=root ) root=parent[root];
+   // And point all the nodes on the path directly at the root
+   while( parent[index]!=root ){
+      unsigned next=parent[index]; parent[index]=root; index=next;
    }
+   return root;
+}
 
-   // Count the size of the cluster
-   cluster_sizes[number_of_cluster].first++;
-   which_cluster[index] = number_of_cluster;
-   return color[index];
+void DFSClustering::join( const unsigned& i, const unsigned& j ){
+   unsigned ri=findRoot(i), rj=findRoot(j);
+   if( ri==rj ) return;
+   // Attach the smaller tree to the larger one so trees remain shallow
+   if( treesize[ri]<treesize[rj] ){ parent[ri]=rj; treesize[rj]+=treesize[ri]; }
+   else { parent[rj]=ri; treesize[ri]+=treesize[rj]; }
 }
 
 }
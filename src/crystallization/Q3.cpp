@@ -206,6 +206,7 @@ Steinhardt(ao)
   coeff_poly[2]=0.0; 
   coeff_poly[3]=2.5;
 
+  setupPolynomialTables();
 }
 
 }
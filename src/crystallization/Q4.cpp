@@ -198,6 +198,7 @@ Steinhardt(ao)
   coeff_poly[0]=0.375; coeff_poly[1]=0.0;
   coeff_poly[2]=-3.75; coeff_poly[3]=0.0;
   coeff_poly[4]=4.375; 
+  setupPolynomialTables();
 }
 
 }
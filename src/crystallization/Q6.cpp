@@ -201,6 +201,7 @@ Steinhardt(ao)
   coeff_poly[2]=6.5625; coeff_poly[3]=0.0;
   coeff_poly[4]=-19.6875; coeff_poly[5]=0.0;
   coeff_poly[6]=14.4375; 
+  setupPolynomialTables();
 }
 
 }
@@ -64,94 +64,132 @@ void Steinhardt::setAngularMomentum( const unsigned& ang ){
   tmom=ang; setVectorDimensionality( 2*ang + 1, true, 2 );
 } 
 
+void Steinhardt::setupPolynomialTables(){
+  plumed_assert( coeff_poly.size()==tmom+1 && normaliz.size()==tmom+1 );
+  poly_table.resize( tmom+1 ); dpoly_table.resize( tmom+1 );
+  for(unsigned m=0;m<=tmom;++m){
+      // The m-th derivative of sum_i c_i z^i is sum_k c_{m+k} (m+k)!/k! z^k
+      poly_table[m].resize( tmom-m+1 ); 
+      for(unsigned k=0;k<=tmom-m;++k){
+          double fact=1.0;
+          for(unsigned j=k+1;j<=m+k;++j) fact=fact*j;
+          poly_table[m][k]=normaliz[m]*coeff_poly[m+k]*fact;
+      }
+      dpoly_table[m].resize( tmom-m, 0.0 );
+      for(unsigned k=0;k<tmom-m;++k) dpoly_table[m][k]=(k+1)*poly_table[m][k+1]; 
+  }
+}
+
 void Steinhardt::calculateVector(){
+  plumed_dbg_assert( poly_table.size()==tmom+1 );
   double dfunc, dpoly_ass, md, tq6, itq6, real_z, imag_z; 
   Vector distance, dz, myrealvec, myimagvec, real_dz, imag_dz;
   // The square root of -1
   std::complex<double> ii( 0.0, 1.0 ), dp_x, dp_y, dp_z;
 
-  double sw, poly_ass, dlen, nbond=0.0; std::complex<double> powered;
+  // First find all the neighbors within the cutoff and compute the switching function
+  // for all of them, so that the expensive loop below runs on a compact block of data
+  if( nb_index.size()<getNAtoms() ){
+      nb_index.resize( getNAtoms() ); nb_distance.resize( getNAtoms() );
+      nb_len.resize( getNAtoms() ); nb_sw.resize( getNAtoms() ); nb_dfunc.resize( getNAtoms() );
+  }
+  unsigned nneigh=0;
   for(unsigned i=1;i<getNAtoms();++i){
      distance=getSeparation( getPosition(0), getPosition(i) );
-     dlen=distance.modulo(); 
+     double dlen=distance.modulo(); 
      if( dlen<rcut ){
-         sw = switchingFunction.calculate( dlen, dfunc ); 
+         nb_index[nneigh]=i; nb_distance[nneigh]=distance; nb_len[nneigh]=dlen; 
+         nb_sw[nneigh]=switchingFunction.calculate( dlen, nb_dfunc[nneigh] ); 
+         nneigh++;
+     }
+  }
+
+  double sw, poly_ass, dlen, nbond=0.0; std::complex<double> powered, zpow;
+  for(unsigned k=0;k<nneigh;++k){
+     unsigned i=nb_index[k]; distance=nb_distance[k]; dlen=nb_len[k];
+     sw=nb_sw[k]; dfunc=nb_dfunc[k];
    
-         nbond += sw;  // Accumulate total number of bonds
-         double dlen3 = dlen*dlen*dlen;
-
-         // Store derivatives of weight
-         MultiColvarBase::addAtomsDerivatives( 0, current_atoms[0], (-dfunc)*distance );
-         MultiColvarBase::addAtomsDerivatives( 0, current_atoms[i], (+dfunc)*distance );
-         MultiColvarBase::addBoxDerivatives( 0, (-dfunc)*Tensor( distance,distance ) ); 
-
-         // Do stuff for m=0
-         poly_ass=deriv_poly( 0, distance[2]/dlen, dpoly_ass );
-         // Derivatives of z/r wrt x, y, z
-         dz = -( distance[2] / dlen3 )*distance; dz[2] += (1.0 / dlen);
-         // Derivative wrt to the vector connecting the two atoms
-         myrealvec = (+sw)*dpoly_ass*dz + poly_ass*(+dfunc)*distance;
-         // Accumulate the derivatives
-         addAtomsDerivative( tmom, 0, -myrealvec );      
-         addAtomsDerivative( tmom, i, myrealvec ); 
-         addBoxDerivatives( tmom, Tensor( -myrealvec,distance ) );
-         // And store the vector function
-         addComponent( tmom, sw*poly_ass );
-
-         // The complex number of which we have to take powers
-         std::complex<double> com1( distance[0]/dlen ,distance[1]/dlen );
-
-         // Do stuff for all other m values
-         for(unsigned m=1;m<=tmom;++m){
-             // Calculate Legendre Polynomial
-             poly_ass=deriv_poly( m, distance[2]/dlen, dpoly_ass );
-             // Calculate powe of complex number
-             powered=pow(com1,m-1); md=static_cast<double>(m);
-             // Real and imaginary parts of z
-             real_z = real(com1*powered); imag_z = imag(com1*powered );
+     nbond += sw;  // Accumulate total number of bonds
+     double idlen = 1.0 / dlen, idlen3 = idlen*idlen*idlen;
+     double zr = distance[2]*idlen;
+
+     // Store derivatives of weight
+     MultiColvarBase::addAtomsDerivatives( 0, current_atoms[0], (-dfunc)*distance );
+     MultiColvarBase::addAtomsDerivatives( 0, current_atoms[i], (+dfunc)*distance );
+     MultiColvarBase::addBoxDerivatives( 0, (-dfunc)*Tensor( distance,distance ) ); 
+
+     // Do stuff for m=0
+     poly_ass=evaluatePolynomial( 0, zr, dpoly_ass );
+     // Derivatives of z/r wrt x, y, z
+     dz = -( distance[2]*idlen3 )*distance; dz[2] += idlen;
+     // Derivative wrt to the vector connecting the two atoms
+     myrealvec = (+sw)*dpoly_ass*dz + poly_ass*(+dfunc)*distance;
+     // Accumulate the derivatives
+     addAtomsDerivative( tmom, 0, -myrealvec );      
+     addAtomsDerivative( tmom, i, myrealvec ); 
+     addBoxDerivatives( tmom, Tensor( -myrealvec,distance ) );
+     // And store the vector function
+     addComponent( tmom, sw*poly_ass );
+
+     // The complex number of which we have to take powers
+     std::complex<double> com1( distance[0]*idlen ,distance[1]*idlen );
+     // These are the parts of the derivatives of (x/r + iy/r) that do not depend on m
+     std::complex<double> dc_x( idlen-distance[0]*distance[0]*idlen3, -distance[0]*distance[1]*idlen3 );
+     std::complex<double> dc_y( -distance[0]*distance[1]*idlen3, idlen-distance[1]*distance[1]*idlen3 ); 
+     std::complex<double> dc_z( -distance[0]*distance[2]*idlen3, -distance[1]*distance[2]*idlen3 );
+
+     // Do stuff for all other m values
+     // The powers of com1 and the sign (-1)^m are built by recurrence on m
+     powered=1.0; double pref=1.0;
+     for(unsigned m=1;m<=tmom;++m){
+         // Calculate Legendre Polynomial
+         poly_ass=evaluatePolynomial( m, zr, dpoly_ass );
+         // powered is (x/r + iy/r)^(m-1), zpow is (x/r + iy/r)^m 
+         md=static_cast<double>(m); zpow=com1*powered;
+         // Real and imaginary parts of z
+         real_z = real(zpow); imag_z = imag(zpow);
  
-             // Calculate steinhardt parameter
-             tq6=poly_ass*real_z;   // Real part of steinhardt parameter
-             itq6=poly_ass*imag_z;  // Imaginary part of steinhardt parameter
-
-             // Derivatives wrt ( x/r + iy )^m
-             dp_x = md*powered*( (1.0/dlen)-(distance[0]*distance[0])/dlen3-ii*(distance[0]*distance[1])/dlen3 );
-             dp_y = md*powered*( ii*(1.0/dlen)-(distance[0]*distance[1])/dlen3-ii*(distance[1]*distance[1])/dlen3 );
-             dp_z = md*powered*( -(distance[0]*distance[2])/dlen3-ii*(distance[1]*distance[2])/dlen3 );
-
-             // Derivatives of real and imaginary parts of above
-             real_dz[0] = real( dp_x ); real_dz[1] = real( dp_y ); real_dz[2] = real( dp_z );
-             imag_dz[0] = imag( dp_x ); imag_dz[1] = imag( dp_y ); imag_dz[2] = imag( dp_z );  
-
-             // Complete derivative of steinhardt parameter
-             myrealvec = (+sw)*dpoly_ass*real_z*dz + (+dfunc)*distance*tq6 + (+sw)*poly_ass*real_dz; 
-             myimagvec = (+sw)*dpoly_ass*imag_z*dz + (+dfunc)*distance*itq6 + (+sw)*poly_ass*imag_dz;
-
-             // Real part
-             addComponent( tmom+m, sw*tq6 );
-             addAtomsDerivative( tmom+m, 0, -myrealvec );
-             addAtomsDerivative( tmom+m, i, myrealvec );
-             addBoxDerivatives( tmom+m, Tensor( -myrealvec,distance ) );
-             // Imaginary part 
-             addImaginaryComponent( tmom+m, sw*itq6 );
-             addImaginaryAtomsDerivative( tmom+m, 0, -myimagvec );
-             addImaginaryAtomsDerivative( tmom+m, i, myimagvec );
-             addImaginaryBoxDerivatives( tmom+m, Tensor( -myimagvec,distance ) );
-             // Store -m part of vector
-             double pref=pow(-1.0,m); 
-             // -m part of vector is just +m part multiplied by (-1.0)**m and multiplied by complex
-             // conjugate of Legendre polynomial
-             // Real part
-             addComponent( tmom-m, pref*sw*tq6 );
-             addAtomsDerivative( tmom-m, 0, -pref*myrealvec );
-             addAtomsDerivative( tmom-m, i, pref*myrealvec );
-             addBoxDerivatives( tmom-m, pref*Tensor( -myrealvec,distance ) );
-             // Imaginary part
-             addImaginaryComponent( tmom-m, -pref*sw*itq6 );
-             addImaginaryAtomsDerivative( tmom-m, 0, pref*myimagvec );
-             addImaginaryAtomsDerivative( tmom-m, i, -pref*myimagvec );
-             addImaginaryBoxDerivatives( tmom-m, pref*Tensor( myimagvec,distance ) );
-         }
+         // Calculate steinhardt parameter
+         tq6=poly_ass*real_z;   // Real part of steinhardt parameter
+         itq6=poly_ass*imag_z;  // Imaginary part of steinhardt parameter
+
+         // Derivatives wrt ( x/r + iy )^m
+         dp_x = md*powered*dc_x; dp_y = md*powered*dc_y; dp_z = md*powered*dc_z;
+
+         // Derivatives of real and imaginary parts of above
+         real_dz[0] = real( dp_x ); real_dz[1] = real( dp_y ); real_dz[2] = real( dp_z );
+         imag_dz[0] = imag( dp_x ); imag_dz[1] = imag( dp_y ); imag_dz[2] = imag( dp_z );  
+
+         // Complete derivative of steinhardt parameter
+         myrealvec = (+sw)*dpoly_ass*real_z*dz + (+dfunc)*distance*tq6 + (+sw)*poly_ass*real_dz; 
+         myimagvec = (+sw)*dpoly_ass*imag_z*dz + (+dfunc)*distance*itq6 + (+sw)*poly_ass*imag_dz;
+
+         // Real part
+         addComponent( tmom+m, sw*tq6 );
+         addAtomsDerivative( tmom+m, 0, -myrealvec );
+         addAtomsDerivative( tmom+m, i, myrealvec );
+         addBoxDerivatives( tmom+m, Tensor( -myrealvec,distance ) );
+         // Imaginary part 
+         addImaginaryComponent( tmom+m, sw*itq6 );
+         addImaginaryAtomsDerivative( tmom+m, 0, -myimagvec );
+         addImaginaryAtomsDerivative( tmom+m, i, myimagvec );
+         addImaginaryBoxDerivatives( tmom+m, Tensor( -myimagvec,distance ) );
+         // Store -m part of vector
+         pref=-pref; 
+         // -m part of vector is just +m part multiplied by (-1.0)**m and multiplied by complex
+         // conjugate of Legendre polynomial
+         // Real part
+         addComponent( tmom-m, pref*sw*tq6 );
+         addAtomsDerivative( tmom-m, 0, -pref*myrealvec );
+         addAtomsDerivative( tmom-m, i, pref*myrealvec );
+         addBoxDerivatives( tmom-m, pref*Tensor( -myrealvec,distance ) );
+         // Imaginary part
+         addImaginaryComponent( tmom-m, -pref*sw*itq6 );
+         addImaginaryAtomsDerivative( tmom-m, 0, pref*myimagvec );
+         addImaginaryAtomsDerivative( tmom-m, i, -pref*myimagvec );
+         addImaginaryBoxDerivatives( tmom-m, pref*Tensor( myimagvec,distance ) );
+         // Next power
+         powered=zpow;
      }
   } 
 
@@ -162,23 +200,6 @@ void Steinhardt::calculateVector(){
   clearDerivativesAfterTask(0);
 }
 
-double Steinhardt::deriv_poly( const unsigned& m, const double& val, double& df ){
-  double fact=1.0;
-  for(unsigned j=1;j<=m;++j) fact=fact*j;
-  double res=coeff_poly[m]*fact;
-
-  double pow=1.0, xi=val, dxi=1.0; df=0.0;
-  for(int i=m+1;i<=tmom;++i){
-      double fact=1.0;
-      for(unsigned j=i-m+1;j<=i;++j) fact=fact*j;
-      res=res+coeff_poly[i]*fact*xi;
-      df = df + pow*coeff_poly[i]*fact*dxi;
-      xi=xi*val; dxi=dxi*val; pow+=1.0;
-  }
-  df = df*normaliz[m];
-  return normaliz[m]*res;
-}
-
 Vector Steinhardt::getCentralAtom(){
   addCentralAtomDerivatives( 0, Tensor::identity() );
   return getPosition(0);
@@ -34,18 +34,40 @@ private:
   unsigned tmom;
   double rcut;
   SwitchingFunction switchingFunction;
+/// Coefficients of the m-th derivative of the Legendre polynomial (times normalization) 
+/// and of its derivative with respect to z.  These are stored so that
+/// the polynomials can be evaluated using Horner's rule
+  std::vector<std::vector<double> > poly_table, dpoly_table;
+/// Tempory storage for the neighbors of the central atom that are within the cutoff
+  std::vector<unsigned> nb_index;
+  std::vector<Vector> nb_distance;
+  std::vector<double> nb_len, nb_sw, nb_dfunc;
 protected:
   std::vector<double> coeff_poly;
   std::vector<double> normaliz;
   void setAngularMomentum( const unsigned& ang );
+/// Setup the tables of polynomial coefficients - must be called once coeff_poly and normaliz are set
+  void setupPolynomialTables();
 public:
   static void registerKeywords( Keywords& keys );
   Steinhardt( const ActionOptions& ao );
   void calculateVector();
   Vector getCentralAtom();
-  double deriv_poly( const unsigned&, const double&, double& );
+/// Evaluate the m-th associated Legendre polynomial and its derivative using the tables built by setupPolynomialTables
+  double evaluatePolynomial( const unsigned& m, const double& val, double& df ) const ;
 };
 
+inline
+double Steinhardt::evaluatePolynomial( const unsigned& m, const double& val, double& df ) const {
+  const std::vector<double>& pp( poly_table[m] ); 
+  const std::vector<double>& dp( dpoly_table[m] );
+  double res=pp[pp.size()-1]; 
+  for(int k=pp.size()-2;k>=0;--k) res=res*val + pp[k];
+  df=0.0;
+  for(int k=dp.size()-1;k>=0;--k) df=df*val + dp[k];
+  return res;
+}
+
 }
 }
 #endif
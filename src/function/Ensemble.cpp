@@ -57,9 +57,15 @@ class Ensemble :
 {
   unsigned  ens_dim;
   double    fact;
+/// Arguments being averaged among replicas
+  std::vector<double> cvs;
+/// Pending reduction among replicas
+  Communicator::Request request;
 public:
   Ensemble(const ActionOptions&);
   void calculate();
+  bool startCalculation();
+  void finishCalculation();
   static void registerKeywords(Keywords& keys);
 };
 
@@ -92,20 +98,32 @@ Function(ao)
 }
 
 void Ensemble::calculate(){
-  for(unsigned i=0;i<getNumberOfArguments();++i){
-    double cv=0.;
-    if(comm.Get_rank()==0) { // I am the master of my replica
-      // among replicas
-      cv = getArgument(i);
-      multi_sim_comm.Sum(&cv, 1);
-      cv *= fact; 
-    }
-    // inside each replica
-    comm.Sum(&cv, 1);
+  startCalculation();
+  finishCalculation();
+}
+
+bool Ensemble::startCalculation(){
+  cvs.assign(getNumberOfArguments(),0.0);
+  if(comm.Get_rank()==0) { // I am the master of my replica
+    // among replicas
+    for(unsigned i=0;i<cvs.size();++i) cvs[i]=getArgument(i);
+    if(!cvs.empty()) request=multi_sim_comm.Isum(&cvs[0],cvs.size());
+  }
+  return true;
+}
+
+void Ensemble::finishCalculation(){
+  if(comm.Get_rank()==0) {
+    request.wait();
+    for(unsigned i=0;i<cvs.size();++i) cvs[i]*=fact;
+  }
+  // inside each replica
+  if(!cvs.empty()) comm.Sum(&cvs[0],cvs.size());
+  for(unsigned i=0;i<cvs.size();++i){
     Value* v=getPntrToComponent(i);
-    v->set(cv);
-    setDerivative(v,cv,fact);
-  };
+    v->set(cvs[i]);
+    setDerivative(v,cvs[i],fact);
+  }
 }
 
 }
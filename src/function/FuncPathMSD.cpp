@@ -177,8 +177,9 @@ void FuncPathMSD::calculate(){
        for(unsigned i=0;i<allArguments.size();i++)neighpair[i].first=allArguments[i]; 
   }
 
-  Value* val_s_path=getPntrToComponent("s");
-  Value* val_z_path=getPntrToComponent("z");
+// components s and z were added in this order in the constructor
+  Value* val_s_path=getPntrToComponent(0);
+  Value* val_z_path=getPntrToComponent(1);
 
   typedef  vector< pair< Value *,double> >::iterator pairiter;
   for(pairiter it=neighpair.begin();it!=neighpair.end();++it){ 
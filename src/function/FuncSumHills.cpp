@@ -185,6 +185,7 @@ class FuncSumHills :
   bool negativebias;
   bool nohistory;
   bool minTOzero;
+  bool binnedhisto;
   bool doInt;
   double lowI_;
   double uppI_;
@@ -208,6 +209,7 @@ void FuncSumHills::registerKeywords(Keywords& keys){
   keys.add("optional","HILLSFILES"," source file for hills creation(may be the same as HILLS)"); // this can be a vector! 
   keys.add("optional","HISTOFILES"," source file for histogram creation(may be the same as HILLS)"); // also this can be a vector!
   keys.add("optional","HISTOSIGMA"," sigmas for binning when the histogram correction is needed    "); 
+  keys.addFlag("HISTOBINNED",false,"bin the histogram points on the grid and then convolve with the gaussian rather than adding one gaussian per point");
   keys.add("optional","PROJ"," only with sumhills: the projection on the cvs");
   keys.add("optional","KT"," only with sumhills: the kt factor when projection on cvs");
   keys.add("optional","GRID_MIN","the lower bounds for the grid");
@@ -238,6 +240,7 @@ parallelread(false),
 negativebias(false),
 nohistory(false),
 minTOzero(false),
+binnedhisto(false),
 doInt(false),
 lowI_(-1.),
 uppI_(-1.),
@@ -317,6 +320,8 @@ historep(NULL)
   if(integratehisto){
   	parseVector("HISTOSIGMA",histoSigma);
         for(unsigned i=0;i<histoSigma.size();i++) log<<"  histosigma  : "<<histoSigma[i]<<"\n";
+        parseFlag("HISTOBINNED",binnedhisto);
+        if(binnedhisto)log<<"  histogram points are binned on the grid and then convolved with the gaussian\n";
   }
 
   // needs a projection? 
@@ -476,6 +481,7 @@ historep(NULL)
     if(integratehisto){
          checkFilesAreExisting(histoFiles); 
          historep=new BiasRepresentation(tmphistovalues,comm,gmin,gmax,gbin,histoSigma);
+         if(binnedhisto) historep->setBinned(true);
     }
 
     // decide how to source hills ( serial/parallel )
@@ -20,6 +20,7 @@
    along with plumed.  If not, see <http://www.gnu.org/licenses/>.
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "Function.h"
+#include "tools/Arena.h"
 
 using namespace std;
 namespace PLMD{
@@ -63,7 +64,7 @@ void Function::addComponentWithDerivatives( const std::string& name ){
 
 void Function::apply(){
 
-  vector<double>   f(getNumberOfArguments(),0.0);
+  ArenaVector<double>::type f(getNumberOfArguments(),0.0);
   bool at_least_one_forced=false;
 
   std::vector<double> forces( getNumberOfArguments() );
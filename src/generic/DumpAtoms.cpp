@@ -30,11 +30,7 @@
 #include <cstdio>
 #include "core/SetupMolInfo.h"
 #include "core/ActionSet.h"
-
-#if defined(__PLUMED_HAS_XDRFILE)
-#include <xdrfile/xdrfile_xtc.h>
-#include <xdrfile/xdrfile_trr.h>
-#endif
+#include "tools/XdrFile.h"
 
 
 using namespace std;
@@ -48,9 +44,8 @@ namespace generic{
 Dump selected atoms on a file.
 
 This command can be used to output the positions of a particular set of atoms.
-The atoms required are ouput in a xyz or gro formatted file.
-If PLUMED has been compiled with xdrfile support, then also xtc and trr files can be read.
-To this aim one should install xdrfile library (http://www.gromacs.org/Developer_Zone/Programming_Guide/XTC_Library).
+The atoms required are ouput in a xyz, gro, xtc or trr formatted file.
+Frames of xtc and trr files are compressed and written in the background while the calculation continues.
 The type of file is automatically detected from the file extension, but can be also
 enforced with TYPE.
 Importantly, if your
@@ -106,12 +101,10 @@ class DumpAtoms:
   std::string fmt_gro_pos;
   std::string fmt_gro_box;
   std::string fmt_xyz;
-#if defined(__PLUMED_HAS_XDRFILE)
-  XDRFILE* xd;
-#endif
+  XdrWriter xd;
+  XdrFrame frame;
 public:
   DumpAtoms(const ActionOptions&);
-  ~DumpAtoms();
   static void registerKeywords( Keywords& keys );
   void calculate(){}
   void apply(){}
@@ -129,11 +122,7 @@ void DumpAtoms::registerKeywords( Keywords& keys ){
   keys.add("compulsory", "FILE", "file on which to output coordinates; extension is automatically detected");
   keys.add("compulsory", "UNITS","PLUMED","the units in which to print out the coordinates. PLUMED means internal PLUMED units");
   keys.add("optional", "PRECISION","The number of digits in trajectory file");
-#if defined(__PLUMED_HAS_XDRFILE)
   keys.add("optional", "TYPE","file type, either xyz, gro, xtc, or trr, can override an automatically detected file extension");
-#else
-  keys.add("optional", "TYPE","file type, either xyz or gro, can override an automatically detected file extension");
-#endif
 
 }
 
@@ -149,11 +138,7 @@ DumpAtoms::DumpAtoms(const ActionOptions&ao):
   if(file.length()==0) error("name out output file was not specified");
     type=Tools::extension(file);
     log<<"  file name "<<file<<"\n";
-  if(type=="gro" || type=="xyz"
-#ifdef __PLUMED_HAS_XDRFILE
-     || type=="xtc" || type=="trr"
-#endif
-  ){
+  if(type=="gro" || type=="xyz" || type=="xtc" || type=="trr"){
     log<<"  file extension indicates a "<<type<<" file\n";
   } else {
     log<<"  file extension not detected, assuming xyz\n";
@@ -162,11 +147,7 @@ DumpAtoms::DumpAtoms(const ActionOptions&ao):
   string ntype;
   parse("TYPE",ntype);
   if(ntype.length()>0){
-    if(ntype!="xyz" && ntype!="gro"
-#ifdef __PLUMED_HAS_XDRFILE
-     && ntype!="xtc" && ntype!="trr"
-#endif
-    ) error("TYPE cannot be understood");
+    if(ntype!="xyz" && ntype!="gro" && ntype!="xtc" && ntype!="trr") error("TYPE cannot be understood");
     log<<"  file type enforced to be "<<ntype<<"\n";
     type=ntype;
   }
@@ -206,15 +187,10 @@ DumpAtoms::DumpAtoms(const ActionOptions&ao):
   std::string path=of.getPath();
   std::string mode=of.getMode();
   log<<"  Writing on file "<<path<<"\n";
-#ifdef __PLUMED_HAS_XDRFILE
-  if(type=="xtc"){
-    of.close();
-    xd=xdrfile_open(path.c_str(),mode.c_str());
-  } else if(type=="trr"){
+  if(type=="xtc" || type=="trr"){
     of.close();
-    xd=xdrfile_open(path.c_str(),mode.c_str());
+    xd.open(path,type,mode);
   }
-#endif
   log.printf("  printing the following atoms in %s :", unitname.c_str() );
   for(unsigned i=0;i<atoms.size();++i) log.printf(" %d",atoms[i].serial() );
   log.printf("\n");
@@ -270,36 +246,19 @@ void DumpAtoms::update(){
            lenunit*t(0,0),lenunit*t(1,1),lenunit*t(2,2),
            lenunit*t(0,1),lenunit*t(0,2),lenunit*t(1,0),
            lenunit*t(1,2),lenunit*t(2,0),lenunit*t(2,1));
-#if defined(__PLUMED_HAS_XDRFILE)
   } else if(type=="xtc" || type=="trr"){
-    matrix box;
     const Tensor & t(getPbc().getBox());
-    rvec* pos=new rvec [getNumberOfAtoms()];
-    for(int i=0;i<3;i++) for(int j=0;j<3;j++) box[i][j]=lenunit*t(i,j);
-    for(int i=0;i<getNumberOfAtoms();i++) for(int j=0;j<3;j++) pos[i][j]=lenunit*getPosition(i)(j);
-    int natoms=getNumberOfAtoms();
-    int step=getStep();
-    float time=getTime()/plumed.getAtoms().getUnits().getTime();
-    float precision=Tools::fastpow(10.0,iprecision);
-    if(type=="xtc"){
-      write_xtc(xd,natoms,step,time,box,pos,precision);
-    } else if(type=="trr"){
-      write_trr(xd,natoms,step,time,0.0,box,pos,NULL,NULL);
-    }
-    delete [] pos;
-#endif
+    frame.natoms=getNumberOfAtoms();
+    frame.step=getStep();
+    frame.time=getTime()/plumed.getAtoms().getUnits().getTime();
+    frame.precision=Tools::fastpow(10.0,iprecision);
+    for(int i=0;i<3;i++) for(int j=0;j<3;j++) frame.box[3*i+j]=lenunit*t(i,j);
+    frame.positions.resize(3*getNumberOfAtoms());
+    for(unsigned i=0;i<getNumberOfAtoms();i++) for(int j=0;j<3;j++) frame.positions[3*i+j]=lenunit*getPosition(i)(j);
+// the frame is copied, compressed and written in the background
+    xd.write(frame);
   } else plumed_merror("unknown file type "+type);
 }
-
-DumpAtoms::~DumpAtoms(){
-#ifdef __PLUMED_HAS_XDRFILE
-  if(type=="xtc") {
-    xdrfile_close(xd);
-  } else if(type=="trr") {
-    xdrfile_close(xd);
-  }
-#endif
-}
   
 
 }
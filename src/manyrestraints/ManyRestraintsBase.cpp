@@ -31,7 +31,7 @@ void ManyRestraintsBase::registerKeywords( Keywords& keys ){
   ActionWithVessel::registerKeywords( keys );
   ActionWithInputVessel::registerKeywords( keys );
   ActionPilot::registerKeywords( keys );
-  keys.add("hidden","STRIDE","the frequency with which the forces due to the bias should be calculated.  This can be used to correctly set up multistep algorithms");
+  keys.add("compulsory","STRIDE","1","the frequency with which the forces due to the bias should be calculated.  Forces are multiplied by the stride, so that this can be used to set up multiple time stepping algorithms.  The bias energy passed to the MD code only includes this bias on the same steps");
   keys.remove("TOL");
   keys.addOutputComponent("bias","default","the instantaneous value of the bias potentials");
 }
@@ -78,7 +78,8 @@ void ManyRestraintsBase::applyChainRuleForDerivatives( const double& df ){
 
 void ManyRestraintsBase::apply(){
   plumed_dbg_assert( getNumberOfComponents()==1 );
-  getPntrToComponent(0)->addForce( -1.0*getStride() );
+// the action can be activated also on other steps, when another action needs its value
+  if(onStep()) getPntrToComponent(0)->addForce( -1.0*getStride() );
 }
 
 }
@@ -106,7 +106,7 @@ ActionWithVessel(ao)
   interpretArgumentList( args, req_args ); requestArguments( req_args );
   // Duplicate all frames (duplicates are used by sketch-map)
   mymap->duplicateFrameList(); 
-  fframes.resize( 2*nfram, 0.0 ); dfframes.resize( 2*nfram, 0.0 );
+  fframes.resize( 2*nfram, 0.0 ); dfframes.resize( 2*nfram, 0.0 ); distframes.resize( nfram, 0.0 );
   plumed_assert( !mymap->mappingNeedsSetup() );
   // Resize all derivative arrays
   mymap->setNumberOfAtomsAndArguments( atoms.size(), args.size() );
@@ -138,7 +138,7 @@ void Mapping::prepare(){
       mymap->duplicateFrameList();
       // Get the number of frames in the path
       unsigned nfram=getNumberOfReferencePoints();
-      fframes.resize( 2*nfram, 0.0 ); dfframes.resize( 2*nfram, 0.0 ); 
+      fframes.resize( 2*nfram, 0.0 ); dfframes.resize( 2*nfram, 0.0 ); distframes.resize( nfram, 0.0 ); 
       plumed_assert( !mymap->mappingNeedsSetup() );
       // Resize all derivative arrays
       mymap->setNumberOfAtomsAndArguments( atoms.size(), args.size() );
@@ -168,6 +168,7 @@ std::string Mapping::getArgumentName( unsigned& iarg ){
 double Mapping::calculateDistanceFunction( const unsigned& ifunc, const bool& squared ){
   // Calculate the distance
   double dd = mymap->calcDistanceFromConfiguration( ifunc, getPositions(), getPbc(), getArguments(), squared );     
+  if( ifunc<distframes.size() ) distframes[ifunc]=dd;
   // Transform distance by whatever
   fframes[ifunc]=transformHD( dd, dfframes[ifunc] );
   return fframes[ifunc];
@@ -51,6 +51,8 @@ private:
 protected:
 /// The (transformed) distance from each frame
   std::vector<double> fframes;
+/// The untransformed distance from each frame
+  std::vector<double> distframes;
 /// Get the number of frames in the path
   unsigned getNumberOfReferencePoints() const ;
 /// Calculate the value of the distance from the ith frame
@@ -47,8 +47,21 @@ the RMSD distance or you could calculate the ammount by which a set of collectiv
 of the path cv allows one to use all the difference distance metrics that are discussed in \ref dists. This is as opposed to 
 the alternative implementation of path (\ref PATHMSD) which is a bit faster but which only allows one to use the RMSD distance.
 
+When the path is described by many frames the distances from all of them need not be computed at every step.  Using 
+NEIGH_SIZE and NEIGH_STRIDE the distances from all the frames are computed every NEIGH_STRIDE steps only and, in between,
+only the NEIGH_SIZE frames that were closest at the last update are used.  If the closest frame reaches the edge of this set of 
+frames all the distances are recomputed immediately.
+
 \par Examples
 
+The following input calculates the path collective variables using the 10 frames that were closest to the
+instantaneous configuration, with the list of closest frames updated every 20 steps.
+
+\verbatim
+p1: PATH REFERENCE=all.pdb LAMBDA=69087 NEIGH_SIZE=10 NEIGH_STRIDE=20
+PRINT ARG=p1.spath,p1.zpath FILE=colvar
+\endverbatim
+
 */
 //+ENDPLUMEDOC
 
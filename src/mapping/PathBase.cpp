@@ -21,6 +21,8 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "PathBase.h"
 #include "tools/SwitchingFunction.h"
+#include "tools/Communicator.h"
+#include <algorithm>
 
 namespace PLMD {
 namespace mapping{
@@ -29,14 +31,31 @@ void PathBase::registerKeywords( Keywords& keys ){
   Mapping::registerKeywords( keys ); 
   keys.add("compulsory","LAMBDA","the value of the lambda parameter for paths");
   keys.addFlag("NOZPATH",false,"do not calculate the zpath position");
+  keys.add("optional","NEIGH_SIZE","only calculate the distances from the NEIGH_SIZE frames that were closest at the last neighbor list update");
+  keys.add("optional","NEIGH_STRIDE","how often (in steps) the distances from all the frames are recomputed to update the neighbor list");
 }
 
 PathBase::PathBase(const ActionOptions& ao):
 Action(ao),
-Mapping(ao)
+Mapping(ao),
+neigh_size(0),
+neigh_stride(0),
+firsttime(true),
+neigh_lower(0),
+neigh_upper(0)
 {
   bool noz; parseFlag("NOZPATH",noz);
   parse("LAMBDA",lambda);
+  parse("NEIGH_SIZE",neigh_size);
+  parse("NEIGH_STRIDE",neigh_stride);
+  if( neigh_size>0 ){
+     if( neigh_stride==0 ) error("NEIGH_STRIDE should be specified when using NEIGH_SIZE");
+     if( neigh_size>getNumberOfReferencePoints() ){
+        log.printf("  list size required ( %u ) is too large: resizing to the number of frames ( %u )\n",neigh_size,getNumberOfReferencePoints());
+        neigh_size=getNumberOfReferencePoints();
+     }
+     log.printf("  using a neighbor list of %u frames updated every %u steps\n",neigh_size,neigh_stride);
+  }
 
   // Create the list of tasks
   for(unsigned i=0;i<getNumberOfReferencePoints();++i) addTaskToList( i );
@@ -49,9 +68,60 @@ double PathBase::getLambda(){
   return lambda;
 }
 
+void PathBase::prepare(){
+  Mapping::prepare();
+  if( neigh_size>0 && neigh_size<getNumberOfReferencePoints() ){
+     // All frames are used at neighbor list update and exchange steps
+     if( firsttime || getStep()%neigh_stride==0 || getExchangeStep() ){ 
+        firsttime=false; unlockContributors(); 
+     }
+  }
+}
+
 void PathBase::calculate(){
+  // Distances are gathered from all nodes so that all nodes can select the same frames
+  if( neigh_size>0 ) distframes.assign( distframes.size(), 0.0 );
   // Loop over all frames is now performed by ActionWithVessel
   runAllTasks();
+  if( neigh_size==0 || neigh_size>=getNumberOfReferencePoints() ) return;
+
+  if( !serialCalculation() ) comm.Sum( distframes );
+  if( contributorsAreUnlocked ){
+     updateFrameList();
+  } else if( closestFrameAtEdge() ){
+     // The system may be closer to a frame outside the list so recompute everything
+     unlockContributors(); 
+     distframes.assign( distframes.size(), 0.0 );
+     runAllTasks(); 
+     if( !serialCalculation() ) comm.Sum( distframes );
+     updateFrameList();
+  }
+}
+
+void PathBase::updateFrameList(){
+  unsigned nfram=getNumberOfReferencePoints();
+  std::vector<std::pair<double,unsigned> > sorted( nfram );
+  for(unsigned i=0;i<nfram;++i) sorted[i]=std::pair<double,unsigned>( distframes[i], i );
+  std::partial_sort( sorted.begin(), sorted.begin()+neigh_size, sorted.end() );
+
+  std::vector<unsigned> active( nfram, 0 );
+  neigh_lower=nfram; neigh_upper=0;
+  for(unsigned i=0;i<neigh_size;++i){
+     unsigned ifram=sorted[i].second; active[ifram]=1;
+     if( ifram<neigh_lower ) neigh_lower=ifram;
+     if( ifram>neigh_upper ) neigh_upper=ifram;
+  }
+  deactivateAllTasks(); activateTheseTasks( active );
+}
+
+bool PathBase::closestFrameAtEdge() const {
+  unsigned iclose=getActiveTask(0);
+  for(unsigned i=1;i<getCurrentNumberOfActiveTasks();++i){
+     if( distframes[getActiveTask(i)]<distframes[iclose] ) iclose=getActiveTask(i);
+  }
+  if( iclose==neigh_lower && neigh_lower>0 ) return true;
+  if( iclose==neigh_upper && neigh_upper+1<getNumberOfReferencePoints() ) return true;
+  return false;
 }
 
 void PathBase::performTask(){
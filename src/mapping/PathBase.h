@@ -30,10 +30,21 @@ namespace mapping{
 class PathBase : public Mapping {
 private:
   double lambda;
+/// The number of frames in the neighbor list and the frequency with which it is updated
+  unsigned neigh_size, neigh_stride;
+/// Is this the first step
+  bool firsttime;
+/// The lowest and highest indices of the frames in the neighbor list
+  unsigned neigh_lower, neigh_upper;
+/// Select the neigh_size closest frames after a calculation over all frames
+  void updateFrameList();
+/// Check if the closest frame is at the edge of the list of active frames
+  bool closestFrameAtEdge() const ;
 public:
   static void registerKeywords( Keywords& keys );
   PathBase(const ActionOptions&);
   double getLambda();
+  void prepare();
   void calculate();
   void performTask();
   double transformHD( const double& dist, double& df );
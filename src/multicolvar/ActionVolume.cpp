@@ -52,6 +52,16 @@ VolumeGradientBase(ao)
   bead.isNotPeriodic(); 
   std::string kerneltype; parse("KERNEL",kerneltype); 
   bead.setKernelType( kerneltype );
+  // The weight along any one direction is bounded by the part of the kernel that lies beyond the edge.
+  // Tasks are only skipped when there is a tolerance below which contributions can be neglected
+  cull=( getNLTolerance()>0 );
+  if( !cull ){
+     tail=0;
+  } else if( kerneltype=="triangular" ){
+     tail=sigma;
+  } else {
+     tail=0; while( 0.5*erfc( tail / (sqrt(2.0)*sigma) )>=getNLTolerance() ) tail+=0.1*sigma;
+  }
   
   if( getPntrToMultiColvar()->isDensity() ){
      std::string input;
@@ -45,6 +45,10 @@ private:
   bool not_in;
 /// The bead for the histogram
   HistogramBead bead;
+/// Are tasks whose central atoms are far from the region skipped
+  bool cull;
+/// Distance beyond the edge of the region at which the kernel weight drops below the tolerance
+  double tail;
 protected:
   double getSigma() const ;
   void addReferenceAtomDerivatives( const unsigned& iatom, const Vector& der );
@@ -57,6 +61,9 @@ public:
 /// Calculate whats in the volume
   void calculateAllVolumes();
   virtual double calculateNumberInside( const Vector& cpos, HistogramBead& bead, Vector& derivatives )=0;
+/// Is the position outside the bounding box of the region once it is extended by tail 
+  virtual bool isOutsideBoundingBox( const Vector&, const double& ){ return false; }
+  bool isOutsideRegion( const Vector& cpos );
   double getValueForTolerance();
   unsigned getIndexOfWeight();
   unsigned getCentralAtomElementIndex();
@@ -84,6 +91,12 @@ void ActionVolume::addBoxDerivatives( const Tensor& vir ){
   else VolumeGradientBase::addBoxDerivatives( nquantities-1, vir );
 }
 
+inline
+bool ActionVolume::isOutsideRegion( const Vector& cpos ){
+  if( not_in || !cull ) return false;
+  return isOutsideBoundingBox( cpos, tail );
+}
+
 inline
 double ActionVolume::getValueForTolerance(){
   return getElementValue( nquantities-1 );
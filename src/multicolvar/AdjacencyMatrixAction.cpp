@@ -181,23 +181,35 @@ void AdjacencyMatrixAction::retrieveMatrix( Matrix<double>& mymatrix ){
   }
 }
 
-void AdjacencyMatrixAction::retrieveAdjacencyLists( std::vector<unsigned>& nneigh, Matrix<unsigned>& adj_list ){
-  plumed_dbg_assert( nneigh.size()==getFullNumberOfBaseTasks() && adj_list.nrows()==getFullNumberOfBaseTasks() && 
-                       adj_list.ncols()==getFullNumberOfBaseTasks() );
+void AdjacencyMatrixAction::retrieveAdjacencyLists( std::vector<unsigned>& offsets, std::vector<unsigned>& neighbors ){
   // Gather active elements in matrix
   if(!gathered) active_elements.mpi_gatherActiveMembers( comm );
   gathered=true;
 
   // Currently everything has zero neighbors
-  for(unsigned i=0;i<nneigh.size();++i) nneigh[i]=0;
-
-  // And set up the adjacency list
-  for(unsigned i=0;i<active_elements.getNumberActive();++i){
+  unsigned nnodes=getFullNumberOfBaseTasks(), nactive=active_elements.getNumberActive();
+  offsets.assign( nnodes+1, 0 ); 
+  
+  // Count the neighbors of each node
+  connected_pairs.resize( 2*nactive );
+  for(unsigned i=0;i<nactive;++i){
       setMatrixIndexesForTask( i );
       unsigned j = current_atoms[1], k = current_atoms[0];
-      adj_list(k,nneigh[k])=j; nneigh[k]++;
-      adj_list(j,nneigh[j])=k; nneigh[j]++;
-  } 
+      connected_pairs[2*i]=k; connected_pairs[2*i+1]=j;
+      offsets[k+1]++; offsets[j+1]++;
+  }
+  for(unsigned i=0;i<nnodes;++i) offsets[i+1]+=offsets[i];
+
+  // And set up the adjacency list - offsets[k] is used as the insertion point for row k
+  // so at the end offsets[k] is the start of row k+1 and everything is shifted back
+  neighbors.resize( 2*nactive );
+  for(unsigned i=0;i<nactive;++i){
+      unsigned k=connected_pairs[2*i], j=connected_pairs[2*i+1];
+      neighbors[offsets[k]]=j; offsets[k]++;
+      neighbors[offsets[j]]=k; offsets[j]++;
+  }
+  for(unsigned i=nnodes;i>0;--i) offsets[i]=offsets[i-1];
+  offsets[0]=0;
 } 
 
 void AdjacencyMatrixAction::addDerivativesOnMatrixElement( const unsigned& ielem, const unsigned& jrow, const double& df, Matrix<double>& der ){
@@ -46,13 +46,16 @@ private:
 /// Which matrix elements have value
   bool gathered;
   DynamicList<unsigned> active_elements;
+/// Tempory storage for the pairs of nodes connected by the active elements
+  std::vector<unsigned> connected_pairs;
 protected:
 /// Retrieve the vessel that holds the adjacency matrix
   AdjacencyMatrixVessel* getAdjacencyVessel();
 /// Get the adjacency matrix
   void retrieveMatrix( Matrix<double>& mymatrix );
-/// Retrieve the adjacency lists
-  void retrieveAdjacencyLists( std::vector<unsigned>& nneigh, Matrix<unsigned>& adj_list );
+/// Retrieve the adjacency lists in compressed sparse row format.  The neighbors of node i 
+/// are in neighbors[offsets[i]] to neighbors[offsets[i+1]-1]
+  void retrieveAdjacencyLists( std::vector<unsigned>& offsets, std::vector<unsigned>& neighbors );
 /// Get number of active matrix elements
   unsigned getNumberOfActiveMatrixElements();
 /// Put the indices of the matrix elements in current atoms
@@ -22,7 +22,9 @@
 #include "MultiColvarBase.h"
 #include "MultiColvarFunction.h"
 #include "BridgedMultiColvarFunction.h"
+#include "VolumeGradientBase.h"
 #include "vesselbase/Vessel.h"
+#include "vesselbase/BridgeVessel.h"
 #include "tools/Pbc.h"
 #include <vector>
 #include <string>
@@ -210,6 +212,27 @@ bool MultiColvarBase::setupCurrentAtomList( const unsigned& taskCode ){
   return true;
 }
 
+void MultiColvarBase::doJobsRequiredBeforeTaskList(){
+  // This prepares the vessels and so sets up the regions in any bridged volumes
+  ActionWithVessel::doJobsRequiredBeforeTaskList();
+  // Tasks can only be skipped on the basis of the regions if every vessel is a bridge to a region
+  screeningRegions.resize(0);
+  for(unsigned i=0;i<getNumberOfVessels();++i){
+     vesselbase::BridgeVessel* bv=dynamic_cast<vesselbase::BridgeVessel*>( getPntrToVessel(i) );
+     VolumeGradientBase* vv=NULL; if( bv ) vv=dynamic_cast<VolumeGradientBase*>( bv->getOutputAction() );
+     if( !vv ){ screeningRegions.resize(0); return; }
+     screeningRegions.push_back( vv );
+  }
+}
+
+bool MultiColvarBase::isOutsideScreeningRegions(){
+  Vector catom=retrieveCentralAtomPos();
+  for(unsigned i=0;i<screeningRegions.size();++i){
+     if( !screeningRegions[i]->isOutsideRegion( catom ) ) return false;
+  }
+  return true;
+}
+
 void MultiColvarBase::performTask(){
   // Currently no atoms have derivatives so deactivate those that are active
   atoms_with_derivatives.deactivateAll();
@@ -218,6 +241,12 @@ void MultiColvarBase::performTask(){
   // Retrieve the atom list
   if( !setupCurrentAtomList( getCurrentTask() ) ) return;
 
+  // Skip the calculation if the central atom is too far from the regions to contribute
+  if( screeningRegions.size()>0 && isOutsideScreeningRegions() ){
+     setWeight( 0.0 ); updateActiveAtoms();
+     return;
+  }
+
   // Do a quick check on the size of this contribution  
   calculateWeight(); // printf("HELLO WEIGHT %f \n",getElementValue(1) );
   if( getElementValue(1)<getTolerance() ){
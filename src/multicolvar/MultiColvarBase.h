@@ -35,6 +35,7 @@ namespace PLMD {
 namespace multicolvar {
 
 class BridgedMultiColvarFunction;
+class VolumeGradientBase;
 
 class MultiColvarBase :
   public ActionAtomistic,
@@ -63,6 +64,10 @@ private:
   StoreCentralAtomsVessel* mycatoms;
 /// A copy of the vessel containg the values of each colvar
   StoreColvarVessel* myvalues;
+/// The regions that can be used to skip tasks whose central atoms are far from all of them
+  std::vector<VolumeGradientBase*> screeningRegions;
+/// Is the central atom of the current task outside all the screening regions
+  bool isOutsideScreeningRegions();
 /// This resizes the local arrays after neighbor list updates and during initialization
   void resizeLocalArrays();
 /// This resizes the arrays that are used for link cell update
@@ -123,6 +128,7 @@ public:
 /// Turn on the derivatives 
   virtual void turnOnDerivatives();
 /// Prepare for the calculation
+  virtual void doJobsRequiredBeforeTaskList();
 /// Perform one of the tasks
   virtual void performTask();
 /// This gets the position of an atom for the link cell setup
@@ -21,6 +21,7 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "AdjacencyMatrixAction.h"
 #include "core/ActionRegister.h"
+#include "tools/Lanczos.h"
 
 //+PLUMEDOC MCOLVARF SPRINT
 /*
@@ -39,6 +40,14 @@ two atoms/molecules are within some cutoff of each other.  Further complexity ca
 insisting that two molecules are adjacent if they are within a certain distance of each 
 other and if they have similar orientations.
 
+The adjacency matrix is never diagonalized completely.  The largest eigenvalue and the corresponding
+eigenvector are found by Lanczos iteration, which only requires products of the (sparse) adjacency matrix 
+with vectors and which is started from the eigenvector found at the previous step.  The derivatives of the 
+eigenvector are obtained by solving, for each SPRINT coordinate, the linear equations for one row of the 
+pseudo-inverse of \f$\lambda I - A\f$ with the conjugate gradient method.  The solution is contracted straight 
+away into the derivatives of that coordinate, so the pseudo-inverse is never stored. 
+The accuracy of both these iterative calculations is controlled by the EIG_TOL keyword.
+
 \par Examples
 
 This example input calculates the 7 SPRINT coordinates for a 7 atom cluster of Lennard-Jones
@@ -76,18 +85,46 @@ PRINT ARG=ss.* FILE=colvar
 namespace PLMD {
 namespace multicolvar {
 
+/// The adjacency matrix stored in compressed sparse row format
+class SparseAdjacencyMatrix : public SymmetricOperator {
+public:
+/// The elements of row i are in columns[offsets[i]] to columns[offsets[i+1]-1]
+  std::vector<unsigned> offsets;
+  std::vector<unsigned> columns;
+  std::vector<double> values;
+  unsigned size() const { return offsets.size()-1; }
+  void apply( const std::vector<double>& x, std::vector<double>& y ) const ;
+};
+
+void SparseAdjacencyMatrix::apply( const std::vector<double>& x, std::vector<double>& y ) const {
+  unsigned n=size(); if( y.size()!=n ) y.resize(n);
+  for(unsigned i=0;i<n;++i){
+     double tmp=0.0;
+     for(unsigned j=offsets[i];j<offsets[i+1];++j) tmp+=values[j]*x[columns[j]];
+     y[i]=tmp;
+  }
+}
+
 class Sprint : public AdjacencyMatrixAction {
 private:
 /// Square root of number of atoms
   double sqrtn;
-/// Vector that stores eigenvalues
-  std::vector<double> eigvals;
+/// Tolerance for the iterative calculations
+  double tolerance;
+/// Largest eigenvalue
+  double lambda;
+/// Eigenvector corresponding to the largest eigenvalue
+  std::vector<double> maxvec;
 /// Vector that stores max eigenvector
   std::vector< std::pair<double,int> > maxeig;
 /// Adjacency matrix
-  Matrix<double> mymatrix;
-/// Matrix that stores eigenvectors
-  Matrix<double> eigenvecs;
+  SparseAdjacencyMatrix mymatrix;
+/// Tempory vectors for the conjugate gradient
+  std::vector<double> cg_r, cg_p, cg_q;
+/// Build the sparse adjacency matrix from the active elements
+  void buildSparseMatrix();
+/// Calculate row m of the pseudo-inverse of lambda*I-A
+  void solvePseudoInverseRow( const unsigned& m, std::vector<double>& row );
 public:
 /// Create manual
   static void registerKeywords( Keywords& keys );
@@ -104,6 +141,7 @@ PLUMED_REGISTER_ACTION(Sprint,"SPRINT")
 void Sprint::registerKeywords( Keywords& keys ){
   AdjacencyMatrixAction::registerKeywords( keys );
   componentsAreNotOptional(keys);
+  keys.add("compulsory","EIG_TOL","1e-10","the tolerance used for the iterative calculations of the largest eigenvalue, of its eigenvector and of their derivatives");
   keys.addOutputComponent("coord","default","all \f$n\f$ sprint coordinates are calculated and then stored in increasing order. "
                                             "the smallest sprint coordinate will be labelled <em>label</em>.coord-1, "
                                             "the second smallest will be labelleled <em>label</em>.coord-1 and so on");
@@ -112,13 +150,13 @@ void Sprint::registerKeywords( Keywords& keys ){
 Sprint::Sprint(const ActionOptions&ao):
 Action(ao),
 AdjacencyMatrixAction(ao),
-eigvals( getFullNumberOfBaseTasks() ),
-maxeig( getFullNumberOfBaseTasks() ),
-mymatrix( getFullNumberOfBaseTasks(), getFullNumberOfBaseTasks() ),
-eigenvecs( getFullNumberOfBaseTasks(), getFullNumberOfBaseTasks() )
+lambda(0),
+maxeig( getFullNumberOfBaseTasks() )
 {
    // Check on setup
    if( getNumberOfVessels()!=1 ) error("there should be no vessel keywords");
+   parse("EIG_TOL",tolerance);
+   log.printf("  tolerance for iterative calculation of eigenvector and derivatives is %e\n",tolerance);
    // Check for bad colvar input
    for(unsigned i=0;i<getNumberOfBaseMultiColvars();++i){
       if( !getBaseMultiColvar(i)->hasDifferentiableOrientation() ) error("cannot use multicolvar of type " + getBaseMultiColvar(i)->getName() );
@@ -134,19 +172,73 @@ eigenvecs( getFullNumberOfBaseTasks(), getFullNumberOfBaseTasks() )
    }
 }
 
+void Sprint::buildSparseMatrix(){
+   unsigned nnodes=getFullNumberOfBaseTasks(), nactive=getNumberOfActiveMatrixElements();
+   mymatrix.offsets.assign( nnodes+1, 0 );
+   for(unsigned i=0;i<nactive;++i){
+      setMatrixIndexesForTask( i );
+      mymatrix.offsets[current_atoms[0]+1]++; mymatrix.offsets[current_atoms[1]+1]++;
+   }
+   for(unsigned i=0;i<nnodes;++i) mymatrix.offsets[i+1]+=mymatrix.offsets[i];
+   // offsets[k] is used as the insertion point for row k so afterwards everything is shifted back
+   mymatrix.columns.resize( 2*nactive ); mymatrix.values.resize( 2*nactive );
+   for(unsigned i=0;i<nactive;++i){
+      setMatrixIndexesForTask( i ); 
+      unsigned k=current_atoms[0], j=current_atoms[1]; double val=getMatrixElement( i );
+      mymatrix.columns[mymatrix.offsets[k]]=j; mymatrix.values[mymatrix.offsets[k]]=val; mymatrix.offsets[k]++;
+      mymatrix.columns[mymatrix.offsets[j]]=k; mymatrix.values[mymatrix.offsets[j]]=val; mymatrix.offsets[j]++;
+   }
+   for(unsigned i=nnodes;i>0;--i) mymatrix.offsets[i]=mymatrix.offsets[i-1];
+   mymatrix.offsets[0]=0;
+}
+
+void Sprint::solvePseudoInverseRow( const unsigned& m, std::vector<double>& row ){
+   // lambda*I-A is positive semi-definite with null space spanned by maxvec so the 
+   // conjugate gradient method is used in the space orthogonal to maxvec
+   unsigned n=maxvec.size();
+   row.assign(n,0.0); cg_r.resize(n);
+   double bnorm2=1.0-maxvec[m]*maxvec[m];
+   if( bnorm2<=0 ) return;
+   // Starting from zero the residual is b, the projection of the m-th unit vector 
+   double rr=0;
+   for(unsigned k=0;k<n;++k){ cg_r[k]=-maxvec[m]*maxvec[k]; }
+   cg_r[m]+=1.0;
+   for(unsigned k=0;k<n;++k) rr+=cg_r[k]*cg_r[k];
+   cg_p=cg_r;
+
+   double tol2=tolerance*tolerance*bnorm2;
+   for(unsigned iter=0;rr>tol2;++iter){
+      if( iter>10*n ) error("conjugate gradient calculation of the derivatives did not converge.  Is the largest eigenvalue degenerate?");
+      mymatrix.apply( cg_p, cg_q );
+      double pq=0, proj=0;
+      for(unsigned k=0;k<n;++k){ cg_q[k]=lambda*cg_p[k]-cg_q[k]; proj+=cg_q[k]*maxvec[k]; }
+      for(unsigned k=0;k<n;++k){ cg_q[k]-=proj*maxvec[k]; pq+=cg_p[k]*cg_q[k]; }
+      double alpha=rr/pq, rrnew=0;
+      for(unsigned k=0;k<n;++k){ row[k]+=alpha*cg_p[k]; cg_r[k]-=alpha*cg_q[k]; rrnew+=cg_r[k]*cg_r[k]; }
+      double beta=rrnew/rr; rr=rrnew;
+      for(unsigned k=0;k<n;++k) cg_p[k]=cg_r[k]+beta*cg_p[k];
+   }
+}
+
 void Sprint::completeCalculation(){
    // Get the adjacency matrix
-   retrieveMatrix( mymatrix ); 
-   // Diagonalize it
-   diagMat( mymatrix, eigvals, eigenvecs );
-   // Get the maximum eigevalue
-   double lambda = eigvals[ getFullNumberOfBaseTasks()-1 ];
+   buildSparseMatrix();
+   // Find the largest eigenvalue starting from the eigenvector at the previous step.  The solver returns 
+   // straight away if this is still an eigenvector.  As the adjacency matrix is non-negative, an eigenvector 
+   // with positive components belongs to the largest eigenvalue (Perron-Frobenius) so the previous eigenvector 
+   // is only used if none of its components vanish (i.e. if the graph was connected)
+   std::vector<double> eigval(1); Matrix<double> eigvec;
+   Lanczos mysolver( mymatrix, tolerance );
+   if( maxvec.size()==getFullNumberOfBaseTasks() && *std::min_element( maxvec.begin(), maxvec.end() )>tolerance ) mysolver.setStartingVector( maxvec );
+   if( mysolver.diagonalize( 1, eigval, eigvec )!=0 ) error("failed to find largest eigenvalue of adjacency matrix");
+   lambda = eigval[0];
    // Get the corresponding eigenvector
+   maxvec.resize( maxeig.size() );
    for(unsigned j=0;j<maxeig.size();++j){
-       maxeig[j].first = fabs( eigenvecs( getFullNumberOfBaseTasks()-1, j ) );
-       maxeig[j].second = j;
        // Must make all components of principle eigenvector +ve
-       eigenvecs( getFullNumberOfBaseTasks()-1, j ) = maxeig[j].first;
+       maxvec[j] = fabs( eigvec(0,j) );
+       maxeig[j].first = maxvec[j];
+       maxeig[j].second = j;
    }
 
    // Reorder each block of eigevectors
@@ -168,17 +260,18 @@ void Sprint::completeCalculation(){
    if( serialCalculation() ){ stride=1; rank=0; }
    else { rank=comm.Get_rank(); stride=comm.Get_size(); } 
 
-   // Derivatives
+   // Derivatives: each rank calculates the derivatives of a subset of the components, solving for 
+   // the corresponding row of the pseudo-inverse of lambda*I-A and using it straight away
    Matrix<double> mymat_ders( getNumberOfComponents(), getNumberOfDerivatives() ); 
-   unsigned nval = getFullNumberOfBaseTasks(); mymat_ders=0; 
-   for(unsigned i=rank;i<getNumberOfActiveMatrixElements();i+=stride){
-      setMatrixIndexesForTask( i ); unsigned j=current_atoms[0], k=current_atoms[1];
-      double tmp1 = 2 * eigenvecs(nval-1,j)*eigenvecs(nval-1,k);
-      for(unsigned icomp=0;icomp<getNumberOfComponents();++icomp){
-          double tmp2 = 0.; 
-          for(unsigned n=0;n<nval-1;++n){  // Need care on following line
-              tmp2 += eigenvecs(n,maxeig[icomp].second) * ( eigenvecs(n,j)*eigenvecs(nval-1,k) + eigenvecs(n,k)*eigenvecs(nval-1,j) ) / ( lambda - eigvals[n] );
-          }
+   mymat_ders=0; std::vector<double> row;
+   unsigned ncomp=getNumberOfComponents();
+   for(unsigned icomp=rank;icomp<ncomp;icomp+=stride){
+      unsigned m=maxeig[icomp].second;
+      solvePseudoInverseRow( m, row );
+      for(unsigned i=0;i<getNumberOfActiveMatrixElements();++i){
+          setMatrixIndexesForTask( i ); unsigned j=current_atoms[0], k=current_atoms[1];
+          double tmp1 = 2 * maxvec[j]*maxvec[k];
+          double tmp2 = row[j]*maxvec[k] + row[k]*maxvec[j];
           addDerivativesOnMatrixElement( i, icomp, sqrtn*( tmp1*maxeig[icomp].first + tmp2*lambda ), mymat_ders );
       }
    }
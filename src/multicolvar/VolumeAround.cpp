@@ -79,6 +79,7 @@ public:
   VolumeAround(const ActionOptions& ao);
   void setupRegions();
   double calculateNumberInside( const Vector& cpos, HistogramBead& bead, Vector& derivatives );
+  bool isOutsideBoundingBox( const Vector& cpos, const double& tail );
 }; 
 
 PLUMED_REGISTER_ACTION(VolumeAround,"AROUND")
@@ -116,6 +117,14 @@ ActionVolume(ao)
 
 void VolumeAround::setupRegions(){ }
 
+bool VolumeAround::isOutsideBoundingBox( const Vector& cpos, const double& tail ){
+  Vector fpos=pbcDistance( getPosition(0), cpos );
+  if( dox && ( fpos[0]<xlow-tail || fpos[0]>xhigh+tail ) ) return true;
+  if( doy && ( fpos[1]<ylow-tail || fpos[1]>yhigh+tail ) ) return true;
+  if( doz && ( fpos[2]<zlow-tail || fpos[2]>zhigh+tail ) ) return true;
+  return false;
+}
+
 double VolumeAround::calculateNumberInside( const Vector& cpos, HistogramBead& bead, Vector& derivatives ){
   // Calculate position of atom wrt to origin
   Vector fpos=pbcDistance( getPosition(0), cpos );
@@ -123,6 +123,7 @@ public:
   void setupRegions();
   void update();
   double calculateNumberInside( const Vector& cpos, HistogramBead& bead, Vector& derivatives );
+  bool isOutsideBoundingBox( const Vector& cpos, const double& tail );
 };
 
 PLUMED_REGISTER_ACTION(VolumeCavity,"CAVITY")
@@ -340,6 +341,18 @@ void VolumeCavity::update(){
   }
 }
 
+bool VolumeCavity::isOutsideBoundingBox( const Vector& cpos, const double& tail ){
+  // The jacobian is never larger than one so the kernel tail bounds the weight here too
+  Vector datom=pbcDistance( origin, cpos );
+  double upos=dotProduct( datom, bi );
+  if( upos<-tail || upos>len_bi+tail ) return true;
+  double vpos=dotProduct( datom, cross );
+  if( vpos<-tail || vpos>len_cross+tail ) return true;
+  double wpos=dotProduct( datom, perp );
+  if( wpos<-tail || wpos>len_perp+tail ) return true;
+  return false;
+}
+
 double VolumeCavity::calculateNumberInside( const Vector& cpos, HistogramBead& bead, Vector& derivatives ){
   // Calculate distance of atom from origin of new coordinate frame
   Vector datom=pbcDistance( origin, cpos );
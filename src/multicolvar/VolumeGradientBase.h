@@ -62,6 +62,8 @@ public:
   virtual void calculateAllVolumes()=0;
 /// Setup the regions that this is based on 
   virtual void setupRegions()=0;
+/// Is this position so far from the region that it cannot contribute (used to skip tasks in the base multicolvar)
+  virtual bool isOutsideRegion( const Vector& ){ return false; }
 /// Forces here are applied through the bridge
   void addBridgeForces( const std::vector<double>& bb );
 };
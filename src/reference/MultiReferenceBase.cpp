@@ -20,6 +20,7 @@
    along with plumed.  If not, see <http://www.gnu.org/licenses/>.
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "MultiReferenceBase.h"
+#include <algorithm>
 #include "tools/Communicator.h"
 #include "MetricRegister.h"
 
@@ -93,11 +94,20 @@ void MultiReferenceBase::setWeights( const std::vector<double>& weights ){
 
 void MultiReferenceBase::calculateAllDistances( const Pbc& pbc, const std::vector<Value*> & vals, Communicator& comm, Matrix<double>& distances, const bool& squared ){
   distances=0.0;
+  // The lower triangle of the matrix is divided into square blocks that are distributed over the nodes.
+  // Working on blocks means that the two sets of frames being compared are reused many times 
+  // while they are in the cache and it also keeps the load on the nodes balanced 
+  const unsigned bsize=32; unsigned nframes=frames.size(), nblocks=( nframes + bsize - 1 ) / bsize;
   unsigned k=0, size=comm.Get_size(), rank=comm.Get_rank(); 
-  for(unsigned i=1;i<frames.size();++i){
-      for(unsigned j=0;j<i;++j){
-          if( (k++)%size!=rank ) continue;         
-          distances(i,j) = distances(j,i) = distance( pbc, vals, frames[i], frames[j], squared );
+  for(unsigned ib=0;ib<nblocks;++ib){
+      for(unsigned jb=0;jb<=ib;++jb){
+          if( (k++)%size!=rank ) continue;
+          unsigned iend=std::min( (ib+1)*bsize, nframes ), jend=std::min( (jb+1)*bsize, nframes );
+          for(unsigned i=ib*bsize;i<iend;++i){
+              for(unsigned j=jb*bsize;j<jend && j<i;++j){
+                  distances(i,j) = distances(j,i) = distance( pbc, vals, frames[i], frames[j], squared );
+              }
+          }
       }
   }
   comm.Sum( distances );
@@ -0,0 +1,155 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Arena.h"
+#include "Exception.h"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef __PLUMED_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace PLMD{
+
+namespace {
+/// Blocks are rounded to this size, so that they all remain aligned
+const std::size_t alignment=16;
+/// Size of the first chunk
+const std::size_t minChunkSize=65536;
+
+std::size_t roundUp(std::size_t bytes){
+  if(bytes==0) return alignment;
+  return (bytes+alignment-1)&~(alignment-1);
+}
+}
+
+Arena::Arena():
+  current(0),
+  live(0),
+  nallocations(0),
+  nchunks(0)
+{
+}
+
+Arena::~Arena(){
+  for(unsigned i=0;i<chunks.size();i++) std::free(chunks[i].data);
+}
+
+void Arena::addChunk(std::size_t size){
+  Chunk c;
+  c.data=static_cast<char*>(std::malloc(size));
+  if(!c.data) throw std::bad_alloc();
+  c.size=size;
+  c.used=0;
+  chunks.push_back(c);
+  nchunks++;
+}
+
+void Arena::rewind(){
+  for(unsigned i=0;i<chunks.size();i++) chunks[i].used=0;
+  current=0;
+}
+
+void* Arena::allocate(std::size_t bytes){
+  std::size_t n=roundUp(bytes);
+  for(;current<chunks.size();current++){
+    Chunk& c=chunks[current];
+    if(c.used+n<=c.size){
+      void* p=c.data+c.used;
+      c.used+=n;
+      nallocations++;
+      live++;
+      return p;
+    }
+  }
+// no room left: each new chunk is at least twice as large as the previous one
+  std::size_t size=minChunkSize;
+  if(!chunks.empty()) size=std::max(size,2*chunks.back().size);
+  addChunk(std::max(size,n));
+  current=chunks.size()-1;
+  chunks[current].used=n;
+  nallocations++;
+  live++;
+  return chunks[current].data;
+}
+
+void Arena::deallocate(void* p,std::size_t bytes){
+  plumed_dbg_assert(live>0);
+  live--;
+  if(live==0){
+    rewind();
+    return;
+  }
+// the last block of the current chunk can be reused immediately
+  Chunk& c=chunks[current];
+  std::size_t n=roundUp(bytes);
+  if(static_cast<char*>(p)+n==c.data+c.used) c.used-=n;
+}
+
+void Arena::reset(){
+  plumed_massert(live==0,"memory from the arena has been kept from one step to the next");
+  if(chunks.size()>1){
+    std::size_t size=getCapacity();
+    for(unsigned i=0;i<chunks.size();i++) std::free(chunks[i].data);
+    chunks.clear();
+    addChunk(size);
+  }
+  rewind();
+}
+
+std::size_t Arena::getCapacity()const{
+  std::size_t size=0;
+  for(unsigned i=0;i<chunks.size();i++) size+=chunks[i].size;
+  return size;
+}
+
+#ifdef __PLUMED_HAS_PTHREAD
+namespace {
+pthread_key_t arenaKey;
+pthread_once_t arenaOnce=PTHREAD_ONCE_INIT;
+
+void deleteArena(void*p){
+  delete static_cast<Arena*>(p);
+}
+
+void createArenaKey(){
+  pthread_key_create(&arenaKey,deleteArena);
+}
+}
+
+Arena& Arena::get(){
+  pthread_once(&arenaOnce,createArenaKey);
+  Arena* arena=static_cast<Arena*>(pthread_getspecific(arenaKey));
+  if(!arena){
+    arena=new Arena;
+    pthread_setspecific(arenaKey,arena);
+  }
+  return *arena;
+}
+#else
+Arena& Arena::get(){
+  static Arena arena;
+  return arena;
+}
+#endif
+
+}
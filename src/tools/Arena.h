@@ -0,0 +1,139 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_Arena_h
+#define __PLUMED_tools_Arena_h
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace PLMD{
+
+/// \ingroup TOOLBOX
+/// Memory pool for the temporaries that are created and destroyed during a step.
+/// Memory is taken from a large chunk by moving a pointer forward. It is given back
+/// when the last block is released, which is the case for local variables, and the
+/// whole chunk is reused as soon as all the blocks have been released.
+/// When the chunk is full a new one is obtained from the heap. At the next reset(),
+/// which PlumedMain calls at the beginning of each step, the chunks are merged into a
+/// single one that is large enough for a whole step, so that after the first steps
+/// no memory is requested from the heap anymore.
+/// Each thread has its own arena, which is returned by Arena::get().
+/// Memory from the arena should only be used by local variables, since it
+/// cannot be kept from one step to the next. It is usually obtained through
+/// the ArenaAllocator adaptor:
+/// \verbatim
+/// ArenaVector<Vector>::type deriv(getNumberOfAtoms());
+/// \endverbatim
+class Arena {
+private:
+  class Chunk {
+  public:
+    char* data;
+    std::size_t size;
+    std::size_t used;
+  };
+  std::vector<Chunk> chunks;
+/// Chunk from which memory is currently taken
+  unsigned current;
+/// Number of blocks that have not been released yet
+  unsigned long live;
+/// Number of blocks allocated since the arena was created
+  unsigned long nallocations;
+/// Number of chunks requested to the heap since the arena was created
+  unsigned long nchunks;
+  void addChunk(std::size_t size);
+/// Make all the chunks available again
+  void rewind();
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+public:
+  Arena();
+  ~Arena();
+/// Allocate a block of memory aligned to 16 bytes
+  void* allocate(std::size_t bytes);
+/// Release a block. bytes should be the size that was requested to allocate()
+  void deallocate(void* p,std::size_t bytes);
+/// Start a new step. All the blocks should have been released
+  void reset();
+/// Number of blocks allocated from the arena
+  unsigned long getNumberOfAllocations()const;
+/// Number of times memory had to be requested to the heap
+  unsigned long getNumberOfHeapAllocations()const;
+/// Total size of the chunks
+  std::size_t getCapacity()const;
+/// Arena of the calling thread
+  static Arena& get();
+};
+
+/// \ingroup TOOLBOX
+/// Standard allocator taking memory from the Arena of the thread that creates it.
+template <class T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  template <class U> struct rebind { typedef ArenaAllocator<U> other; };
+  Arena* arena;
+  ArenaAllocator(): arena(&Arena::get()) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& a): arena(a.arena) {}
+  pointer address(reference x)const{ return &x; }
+  const_pointer address(const_reference x)const{ return &x; }
+  pointer allocate(size_type n,const void* =0){ return static_cast<pointer>(arena->allocate(n*sizeof(T))); }
+  void deallocate(pointer p,size_type n){ arena->deallocate(p,n*sizeof(T)); }
+  size_type max_size()const{ return size_type(-1)/sizeof(T); }
+  void construct(pointer p,const T& val){ new(static_cast<void*>(p)) T(val); }
+  void destroy(pointer p){ p->~T(); }
+};
+
+template <class T,class U>
+bool operator==(const ArenaAllocator<T>& a,const ArenaAllocator<U>& b){ return a.arena==b.arena; }
+
+template <class T,class U>
+bool operator!=(const ArenaAllocator<T>& a,const ArenaAllocator<U>& b){ return a.arena!=b.arena; }
+
+/// \ingroup TOOLBOX
+/// Vector taking its memory from the Arena, ArenaVector<T>::type
+template <class T>
+class ArenaVector {
+public:
+  typedef std::vector<T,ArenaAllocator<T> > type;
+};
+
+inline
+unsigned long Arena::getNumberOfAllocations()const{
+  return nallocations;
+}
+
+inline
+unsigned long Arena::getNumberOfHeapAllocations()const{
+  return nchunks;
+}
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "AsyncGridWriter.h"
+#include "Grid.h"
+#include "OFile.h"
+#include "Exception.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <typeinfo>
+#include <exception>
+
+namespace PLMD{
+
+AsyncGridWriter::AsyncGridWriter():
+  snapshot(NULL),
+  append(false),
+  busy(false)
+{
+}
+
+AsyncGridWriter::~AsyncGridWriter(){
+#ifdef __PLUMED_HAS_PTHREAD
+// errors cannot be reported from here
+  if(busy) pthread_join(thread,NULL);
+#endif
+  if(snapshot) delete snapshot;
+}
+
+void AsyncGridWriter::setFile(const std::string& path,bool append){
+  wait();
+  this->path=path;
+  this->append=append;
+}
+
+void AsyncGridWriter::write(){
+  if(append){
+    OFile ofile;
+    ofile.enforceRestart();
+    ofile.open(path);
+    snapshot->writeToFile(ofile);
+    ofile.close();
+    return;
+  }
+// the temporary file is in the same directory, so that it can be renamed atomically
+  size_t found=path.find_last_of("/\\");
+  std::string tmp=path.substr(0,found+1)+"tmp."+path.substr(found+1);
+  std::remove(tmp.c_str());
+  {
+    OFile ofile;
+    ofile.open(tmp);
+    snapshot->writeToFile(ofile);
+    ofile.close();
+  }
+  if(std::rename(tmp.c_str(),path.c_str())!=0) error="renaming "+tmp+" into "+path+" failed for reason: "+std::strerror(errno);
+}
+
+void* AsyncGridWriter::run(void*ptr){
+  AsyncGridWriter* writer=static_cast<AsyncGridWriter*>(ptr);
+// exceptions cannot cross the thread boundary, they are reported by wait()
+  try{
+    writer->write();
+  } catch(std::exception& e){
+    writer->error=e.what();
+  } catch(...){
+    writer->error="unknown error while writing "+writer->path;
+  }
+  return NULL;
+}
+
+void AsyncGridWriter::dump(const Grid& grid){
+  plumed_massert(path.length()>0,"file for grid should be set before dumping");
+  wait();
+// dense grids reuse the same buffer, copying is much faster than writing
+  if(snapshot && typeid(*snapshot)==typeid(Grid) && typeid(grid)==typeid(Grid)) *snapshot=grid;
+  else {
+    if(snapshot) delete snapshot;
+    snapshot=grid.clone();
+  }
+#ifdef __PLUMED_HAS_PTHREAD
+  if(pthread_create(&thread,NULL,&AsyncGridWriter::run,this)==0){
+    busy=true;
+    return;
+  }
+#endif
+// no thread available, write now
+  write();
+  wait();
+}
+
+void AsyncGridWriter::wait(){
+#ifdef __PLUMED_HAS_PTHREAD
+  if(busy) pthread_join(thread,NULL);
+#endif
+  busy=false;
+  if(error.length()>0){
+    std::string msg=error;
+    error="";
+    plumed_merror(msg);
+  }
+}
+
+}
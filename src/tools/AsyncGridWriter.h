@@ -0,0 +1,82 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_AsyncGridWriter_h
+#define __PLUMED_tools_AsyncGridWriter_h
+
+#include <string>
+
+#ifdef __PLUMED_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace PLMD{
+
+class Grid;
+
+/// \ingroup TOOLBOX
+/// Writes snapshots of a Grid to a file without stopping the caller.
+/// When dump() is called the grid is copied, and the copy is written by a
+/// background thread while the caller keeps updating the original.
+/// A new dump first waits for the previous one to complete.
+/// Unless snapshots are appended one after the other, each of them is written
+/// to a temporary file that is then renamed, so that the file always contains
+/// a complete grid, even if the program is killed while writing.
+/// Without pthread support snapshots are written immediately.
+class AsyncGridWriter {
+private:
+/// The copy of the grid being written
+  Grid* snapshot;
+/// The file where grids are written
+  std::string path;
+/// True if grids are appended to the file
+  bool append;
+/// True if a background write is in progress
+  bool busy;
+/// Error raised by the last write, reported on the next call to wait()
+  std::string error;
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_t thread;
+#endif
+/// Write the snapshot
+  void write();
+/// Entry point of the background thread
+  static void* run(void*);
+/// Disallow copy
+  AsyncGridWriter(const AsyncGridWriter&);
+/// Disallow copy
+  AsyncGridWriter& operator=(const AsyncGridWriter&);
+public:
+  AsyncGridWriter();
+/// Waits for the last snapshot to be written
+  ~AsyncGridWriter();
+/// Set the file. If append is true grids are added at the end of it,
+/// otherwise each of them replaces the previous one
+  void setFile(const std::string& path,bool append);
+/// Start writing a snapshot of the grid
+  void dump(const Grid&);
+/// Wait for the last snapshot to be written
+  void wait();
+};
+
+}
+
+#endif
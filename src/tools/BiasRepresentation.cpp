@@ -27,7 +27,7 @@
 namespace PLMD {
 
 /// the constructor here
-BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc ):hasgrid(false),mycomm(cc),BiasGrid_(NULL){
+BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc ):hasgrid(false),mycomm(cc),BiasGrid_(NULL),binnedkde(NULL){
     doInt_=false;
     ndim=tmpvalues.size();
     for(int i=0;i<ndim;i++){
@@ -36,7 +36,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
     } 
 }
 /// overload the constructor: add the sigma  at constructor time 
-BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc,  vector<double> sigma ):hasgrid(false),histosigma(sigma),mycomm(cc),BiasGrid_(NULL){
+BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc,  vector<double> sigma ):hasgrid(false),histosigma(sigma),mycomm(cc),BiasGrid_(NULL),binnedkde(NULL){
     doInt_=false;
     ndim=tmpvalues.size();
     for(int i=0;i<ndim;i++){
@@ -46,7 +46,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
 } 
 /// overload the constructor: add the grid at constructor time 
 BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc , vector<string> gmin, vector<string> gmax, 
-                                       vector<unsigned> nbin, bool doInt, double lowI, double uppI ):hasgrid(false), rescaledToBias(false), mycomm(cc), BiasGrid_(NULL){
+                                       vector<unsigned> nbin, bool doInt, double lowI, double uppI ):hasgrid(false), rescaledToBias(false), mycomm(cc), BiasGrid_(NULL),binnedkde(NULL){
     ndim=tmpvalues.size();
     for(int  i=0;i<ndim;i++){
          values.push_back(tmpvalues[i]);
@@ -59,7 +59,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
     addGrid(gmin,gmax,nbin);
 } 
 /// overload the constructor with some external sigmas: needed for histogram
-BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc , vector<string> gmin, vector<string> gmax, vector<unsigned> nbin , vector<double> sigma):hasgrid(false), rescaledToBias(false),histosigma(sigma),mycomm(cc),BiasGrid_(NULL){
+BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc , vector<string> gmin, vector<string> gmax, vector<unsigned> nbin , vector<double> sigma):hasgrid(false), rescaledToBias(false),histosigma(sigma),mycomm(cc),BiasGrid_(NULL),binnedkde(NULL){
     doInt_=false;
     ndim=tmpvalues.size();
     for(int  i=0;i<ndim;i++){
@@ -72,6 +72,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
 
 BiasRepresentation::~BiasRepresentation(){
   if(BiasGrid_) delete BiasGrid_;
+  if(binnedkde) delete binnedkde;
   for(unsigned i=0;i<hills.size();i++) delete hills[i];
 }
 
@@ -91,6 +92,16 @@ void BiasRepresentation::setRescaledToBias(bool rescaled){
 	plumed_massert(hills.size()==0,"you can set the rescaling function only before loading hills");
         rescaledToBias=rescaled;
 }
+void BiasRepresentation::setBinned(bool binned){
+	plumed_massert(hills.size()==0,"you can set the binning only before loading hills");
+	if(binnedkde){delete binnedkde; binnedkde=NULL;}
+	if(binned){
+		plumed_massert(hasgrid && histosigma.size()!=0,"binning is only possible for histograms with a grid");
+		// kernels truncated to an interval cannot be obtained by convolution
+		plumed_massert(!doInt_,"binning is not compatible with integration in an interval");
+		binnedkde=new BinnedKernelDensity(*BiasGrid_,histosigma,false);
+	}
+}
 const bool & BiasRepresentation::isRescaledToBias(){
 	return rescaledToBias;
 }
@@ -154,7 +165,12 @@ void BiasRepresentation::pushKernel( IFile *ifile ){
         }
         // if grid is defined then it should be added on the grid    
  	//cerr<<"now with "<<hills.size()<<endl;
-        if(hasgrid){
+        if(hasgrid && binnedkde){
+                 // the grid is only updated when it is requested
+                 double w=1.0;
+                 if(rescaledToBias) w=(biasf.back()-1.)/(biasf.back());
+                 binnedkde->addPoint(kk->getCenter(),w);
+        } else if(hasgrid){
                  vector<unsigned> nneighb;
                  if(doInt_) nneighb=BiasGrid_->getNbin();
                  else nneighb=kk->getSupport(BiasGrid_->getDx());
@@ -214,6 +230,10 @@ int BiasRepresentation::getNumberOfKernels(){
 }
 Grid* BiasRepresentation::getGridPtr(){
         plumed_massert(hasgrid,"if you want the grid pointer then you should have defined a grid before"); 
+        if(binnedkde){
+              binnedkde->addToGrid(*BiasGrid_);
+              binnedkde->clear();
+        }
 	return BiasGrid_;
 }
 void BiasRepresentation::getMinMaxBin(vector<double> &vmin, vector<double> &vmax, vector<unsigned> &vbin){
@@ -261,6 +281,7 @@ void BiasRepresentation::clear(){
         if(hasgrid){
               BiasGrid_->clear();
         }
+        if(binnedkde) binnedkde->clear();
 }
 
 
@@ -26,6 +26,7 @@
 #include "KernelFunctions.h"
 #include "File.h"
 #include "Grid.h"
+#include "BinnedKernelDensity.h"
 #include <iostream>
 
 using namespace std;
@@ -63,6 +64,8 @@ class BiasRepresentation {
 	  void 		pushKernel( IFile * ff);
           /// set the flag that rescales the free energy to the bias 
 	  void 		setRescaledToBias(bool rescaled);
+          /// bin the histogram points on the grid and convolve them with the kernel instead of adding kernels one by one
+	  void 		setBinned(bool binned);
           /// check if the representation is rescaled to the bias 
    	  const bool & 	isRescaledToBias();
           /// check if the sigma values are already provided (in case of a histogram representation with input sigmas)
@@ -99,6 +102,7 @@ class BiasRepresentation {
     vector<double> histosigma;	
     Communicator& mycomm;
     Grid* BiasGrid_;
+    BinnedKernelDensity* binnedkde;
 };
 
 }
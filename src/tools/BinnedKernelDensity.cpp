@@ -0,0 +1,159 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "BinnedKernelDensity.h"
+#include "Grid.h"
+#include "Communicator.h"
+#include "Exception.h"
+#include "Tools.h"
+#include <cmath>
+
+namespace PLMD {
+
+BinnedKernelDensity::BinnedKernelDensity( const Grid& grid, const std::vector<double>& sigma, const bool& normalize ):
+dimension(grid.getDimension()),
+pbc(grid.getIsPeriodic()),
+min(dimension),
+dx(grid.getDx()),
+nbin(grid.getNbin()),
+nbinned(dimension),
+pad(dimension),
+stride(dimension),
+height(1.0),
+kernel(dimension),
+dkernel(dimension)
+{
+  plumed_massert( sigma.size()==dimension, "number of widths does not match dimension of grid" );
+  std::vector<std::string> smin( grid.getMin() );
+  // The support of the kernels is the same as that used in KernelFunctions
+  const double DP2CUTOFF=6.25; unsigned ntot=1;
+  for(unsigned i=0;i<dimension;++i){
+      Tools::convert( smin[i], min[i] );
+      int support=static_cast<int>( std::ceil( std::sqrt(2.0*DP2CUTOFF)*sigma[i] / dx[i] ) );
+      if( pbc[i] ){
+         // There is no point in a kernel that wraps around the box more than once
+         if( 2*support+1>static_cast<int>(nbin[i]) ) support=(nbin[i]-1)/2;
+         pad[i]=0; 
+      } else {
+         pad[i]=support;
+      }
+      nbinned[i]=nbin[i]+2*pad[i];
+      stride[i]=ntot; ntot*=nbinned[i];
+
+      kernel[i].resize( 2*support+1 ); dkernel[i].resize( 2*support+1 );
+      for(int m=-support;m<=support;++m){
+          double dd=m*dx[i]/sigma[i], ee=std::exp( -0.5*dd*dd );
+          kernel[i][m+support]=ee; dkernel[i][m+support]=-dd*ee/sigma[i];
+      }
+      if( normalize ) height /= std::sqrt( 2*pi )*sigma[i];
+  }
+  binned.resize( ntot, 0.0 );
+}
+
+void BinnedKernelDensity::clear(){
+  for(unsigned i=0;i<binned.size();++i) binned[i]=0.0;
+}
+
+void BinnedKernelDensity::sum( Communicator& comm ){
+  comm.Sum( binned );
+}
+
+void BinnedKernelDensity::addPoint( const std::vector<double>& x, const double& w ){
+  plumed_dbg_assert( x.size()==dimension );
+  // Find the lower corner of the cell containing the point and the fractional position in the cell
+  std::vector<int> lower( dimension ); std::vector<double> frac( dimension );
+  for(unsigned i=0;i<dimension;++i){
+      double t=( x[i]-min[i] ) / dx[i];
+      double fl=std::floor( t ); frac[i]=t-fl;
+      lower[i]=static_cast<int>( fl ) + pad[i];
+  }
+  // Share the weight between the corners of the cell 
+  unsigned ncorners=1<<dimension;
+  for(unsigned c=0;c<ncorners;++c){
+      double ww=w; int index=0; bool inside=true;
+      for(unsigned i=0;i<dimension;++i){
+          int ii=lower[i];
+          if( c & (1<<i) ){ ii++; ww*=frac[i]; } 
+          else ww*=( 1.0 - frac[i] );
+          if( pbc[i] ){
+             ii%=static_cast<int>(nbinned[i]); if( ii<0 ) ii+=nbinned[i];
+          } else if( ii<0 || ii>=static_cast<int>(nbinned[i]) ){
+             inside=false; break;
+          }
+          index+=ii*stride[i];
+      }
+      if( inside ) binned[index]+=ww;
+  }
+}
+
+void BinnedKernelDensity::convolve( const unsigned& idim, const std::vector<double>& kern, const std::vector<double>& in, std::vector<double>& out ) const {
+  int support=( kern.size()-1 ) / 2, n=nbinned[idim]; unsigned st=stride[idim];
+  out.assign( in.size(), 0.0 );
+  for(unsigned index=0;index<in.size();++index){
+      int ii=( index / st ) % n; unsigned base=index - ii*st;
+      double tmp=0;
+      for(int m=-support;m<=support;++m){
+          int jj=ii-m;
+          if( pbc[idim] ){
+             if( jj<0 ) jj+=n; else if( jj>=n ) jj-=n;
+          } else if( jj<0 || jj>=n ) continue;
+          tmp+=kern[m+support]*in[base + jj*st];
+      }
+      out[index]=tmp;
+  }
+}
+
+void BinnedKernelDensity::addToGrid( Grid& grid ) const {
+  plumed_massert( grid.getDimension()==dimension && grid.getNbin()==nbin, "grid does not match the one used to setup the binning" );
+  bool usederiv=grid.hasDerivatives();
+  unsigned nder=( usederiv ? dimension : 0 );
+
+  // The density and then the derivative along each direction are obtained by convolving with 
+  // a product of one dimensional kernels.  
+  std::vector<std::vector<double> > result( nder+1 );
+  std::vector<double> work;
+  for(unsigned k=0;k<=nder;++k){
+      result[k]=binned;
+      for(unsigned i=0;i<dimension;++i){
+          if( k>0 && i==k-1 ) convolve( i, dkernel[i], result[k], work );
+          else convolve( i, kernel[i], result[k], work );
+          result[k].swap( work );
+      }
+  }
+
+  // Now transfer the result for the points that lie on the grid
+  std::vector<unsigned> indices( dimension ); std::vector<double> der( dimension );
+  for(unsigned index=0;index<grid.getSize();++index){
+      unsigned kk=index, bindex=0;
+      for(unsigned i=0;i<dimension;++i){ 
+          indices[i]=kk%nbin[i]; kk/=nbin[i];
+          bindex+=( indices[i]+pad[i] )*stride[i];
+      }
+      if( usederiv ){
+         for(unsigned i=0;i<dimension;++i) der[i]=height*result[i+1][bindex];
+         grid.addValueAndDerivatives( index, height*result[0][bindex], der );
+      } else {
+         grid.addValue( index, height*result[0][bindex] );
+      }
+  }
+}
+
+}
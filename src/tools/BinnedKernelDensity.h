@@ -0,0 +1,81 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_BinnedKernelDensity_h
+#define __PLUMED_tools_BinnedKernelDensity_h
+
+#include <vector>
+
+namespace PLMD {
+
+class Grid;
+class Communicator;
+
+/**
+\ingroup TOOLBOX
+Kernel density estimation on a grid using linear binning.
+
+Rather than evaluating one kernel for each data point on all the grid points in its support 
+the weight of each data point is first shared between the corners of the grid cell that contains it.  The binned 
+weights are then convolved with a gaussian kernel with a diagonal bandwidth.  As the gaussian
+is separable this convolution is done one dimension at a time so the cost does not depend on the number of data 
+points.  The binning array is padded in non periodic directions so that points that lie just outside the 
+grid still contribute to the density close to the grid edges.
+*/
+
+class BinnedKernelDensity {
+private:
+/// The dimensionality of the grid
+  unsigned dimension;
+/// Are the directions periodic
+  std::vector<bool> pbc;
+/// The position of the first grid point and the grid spacing
+  std::vector<double> min, dx;
+/// The number of points in the grid and in the padded binning array
+  std::vector<unsigned> nbin, nbinned;
+/// The padding at the start of each direction of the binning array
+  std::vector<unsigned> pad;
+/// The strides for the binning array
+  std::vector<unsigned> stride;
+/// The height of the normalized kernel
+  double height;
+/// The one dimensional kernel and its derivative at the grid separations in each direction
+  std::vector<std::vector<double> > kernel, dkernel;
+/// The binned weights
+  std::vector<double> binned;
+/// Convolve data along direction idim
+  void convolve( const unsigned& idim, const std::vector<double>& kern, const std::vector<double>& in, std::vector<double>& out ) const ;
+public:
+/// Setup kernel density estimation on grid using gaussians with widths sigma.  If normalize is true
+/// the kernels integrate to the weights of the points otherwise their heights equal the weights.
+  BinnedKernelDensity( const Grid& grid, const std::vector<double>& sigma, const bool& normalize );
+/// Add a point with weight w
+  void addPoint( const std::vector<double>& x, const double& w );
+/// Sum the binned weights from all the nodes
+  void sum( Communicator& comm );
+/// Clear all the binned weights
+  void clear();
+/// Add the kernel density (and its derivatives if the grid stores them) to the grid 
+  void addToGrid( Grid& grid ) const ;
+};
+
+}
+#endif
@@ -40,6 +40,12 @@ Communicator::Communicator(const Communicator&pc){
 
 Communicator::Status Communicator::StatusIgnore;
 
+#ifdef __PLUMED_MPI
+const int Communicator::AnySource=MPI_ANY_SOURCE;
+#else
+const int Communicator::AnySource=-1;
+#endif
+
 Communicator& Communicator::operator=(const Communicator&pc){
   if (this != &pc){
       Set_comm(pc.communicator);
@@ -140,6 +146,20 @@ void Communicator::Sum(Data data){
 #endif
 }
 
+Communicator::Request Communicator::Isum(Data data){
+  Request req;
+#if defined(__PLUMED_MPI)
+#if MPI_VERSION>=3
+  if(initialized()) MPI_Iallreduce(MPI_IN_PLACE,data.pointer,data.size,data.type,MPI_SUM,communicator,&req.r);
+#else
+  if(initialized()) MPI_Allreduce(MPI_IN_PLACE,data.pointer,data.size,data.type,MPI_SUM,communicator);
+#endif
+#else
+  (void) data;
+#endif
+  return req;
+}
+
 Communicator::Request Communicator::Isend(ConstData data,int source,int tag){
   Request req;
 #ifdef __PLUMED_MPI
@@ -173,6 +193,23 @@ void Communicator::Allgatherv(ConstData in,Data out,const int*recvcounts,const i
 #endif
 }
 
+void Communicator::Allgatherv(ConstData in,Data out,AllgathervPlan&plan){
+  const int n=Get_size();
+  plan.newcounts.resize(n);
+  Allgather(ConstData(&in.size,1),Data(&plan.newcounts[0],n));
+  if(plan.newcounts!=plan.counts){
+    plan.counts=plan.newcounts;
+    plan.displ.resize(n);
+    plan.displ[0]=0;
+    for(int i=1;i<n;++i) plan.displ[i]=plan.displ[i-1]+plan.counts[i-1];
+  }
+  const int*counts=&plan.counts[0];
+  const int*displ=&plan.displ[0];
+// const reference, so that the copy constructor of Data is used
+  const Data& outref=out;
+  Allgatherv(in,outref,counts,displ);
+}
+
 void Communicator::Allgather(ConstData in,Data out){
 #if defined(__PLUMED_MPI)
   plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
@@ -224,14 +261,21 @@ bool Communicator::initialized(){
   else return false;
 }
 
+Communicator::Request::Request(){
+#ifdef __PLUMED_MPI
+  r=MPI_REQUEST_NULL;
+#endif
+}
+
 void Communicator::Request::wait(Status&s){
 #ifdef __PLUMED_MPI
- plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+  if(r==MPI_REQUEST_NULL) return;
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
   if(&s==&StatusIgnore) MPI_Wait(&r,MPI_STATUS_IGNORE);
   else MPI_Wait(&r,&s.s);
 #else
+// requests can only be non-null with MPI (Isend fails without it), so there is nothing to wait for
   (void) s;
-  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
 #endif
 }
 
@@ -78,8 +78,8 @@ class Communicator{
    template <unsigned n,unsigned m> Data(TensorGeneric<n,m> *p,int s): pointer(p), size(n*m*s), type(getMPIType<double>()) {}
 /// Init from reference to TensorGeneric
    template <unsigned n,unsigned m> Data(TensorGeneric<n,m> &p): pointer(&p), size(n*m), type(getMPIType<double>()) {}
-/// Init from reference to std::vector
-    template <typename T> Data(std::vector<T>&v){
+/// Init from reference to std::vector, with any allocator
+    template <typename T,class A> Data(std::vector<T,A>&v){
       if(v.size()>0){ Data d(&v[0],v.size()); pointer=d.pointer; size=d.size; type=d.type; }
       else { pointer=NULL; size=0; }
     }
@@ -106,7 +106,7 @@ class Communicator{
     template <unsigned n> ConstData(const VectorGeneric<n> &p): pointer(&p), size(n), type(getMPIType<double>()) {}
     template <unsigned n,unsigned m> ConstData(const TensorGeneric<n,m> *p,int s): pointer(p), size(n*m*s), type(getMPIType<double>()) {}
     template <unsigned n,unsigned m> ConstData(const TensorGeneric<n,m> &p): pointer(&p), size(n*m), type(getMPIType<double>()) {}
-    template <typename T> ConstData(const std::vector<T>&v){
+    template <typename T,class A> ConstData(const std::vector<T,A>&v){
       if(v.size()>0){ ConstData d(&v[0],v.size()); pointer=d.pointer; size=d.size; type=d.type; }
       else { pointer=NULL; size=0; }
     }
@@ -137,8 +137,24 @@ public:
   class Request{
   public:
     MPI_Request r;
+/// Constructs a null request, for which wait() returns immediately
+    Request();
     void wait(Status&s=StatusIgnore);
   };
+/// Persistent plan for repeated calls to Allgatherv.
+/// It stores the receive counts and displacements, which are recomputed
+/// only when the amount of data sent by one of the processes changes.
+  class AllgathervPlan{
+    friend class Communicator;
+    std::vector<int> counts;
+    std::vector<int> displ;
+    std::vector<int> newcounts;
+  public:
+/// Total number of elements received in the last call
+    int getTotal()const{return (counts.size()>0?displ.back()+counts.back():0);}
+  };
+/// Wildcard to be used as a source in Recv (i.e. MPI_ANY_SOURCE)
+  static const int AnySource;
 /// Default constructor
   Communicator();
 /// Copy constructor.
@@ -182,6 +198,15 @@ public:
 /// Wrapper for MPI_Allreduce with MPI_SUM (reference)
   template <class T> void Sum(T&buf){Sum(Data(buf));}
 
+/// Non-blocking version of Sum (data struct).
+/// The buffer should not be touched until wait() has been called on the returned request.
+/// With MPI libraries older than MPI-3 the reduction is completed before returning.
+  Request Isum(Data);
+/// Non-blocking version of Sum (pointer)
+  template <class T> Request Isum(T*buf,int count){return Isum(Data(buf,count));}
+/// Non-blocking version of Sum (reference)
+  template <class T> Request Isum(T&buf){return Isum(Data(buf));}
+
 /// Wrapper for MPI_Bcast (data struct)
   void Bcast(Data,int);
 /// Wrapper for MPI_Bcast (pointer)
@@ -205,6 +230,13 @@ public:
   template <class T,class S> void Allgatherv(const T&sendbuf,S&recvbuf,const int*recvcounts,const int*displs){
     Allgatherv(ConstData(sendbuf),Data(recvbuf),recvcounts,displs);}
 
+/// Wrapper for MPI_Allgatherv using a persistent plan (data struct).
+/// The number of elements sent by each process is exchanged and counts/displacements
+/// are only recomputed when it changes.
+  void Allgatherv(ConstData in,Data out,AllgathervPlan&plan);
+/// Wrapper for MPI_Allgatherv using a persistent plan (pointer)
+  template <class T,class S> void Allgatherv(const T*sendbuf,int sendcount,S*recvbuf,AllgathervPlan&plan){
+    Allgatherv(ConstData(sendbuf,sendcount),Data(recvbuf,0),plan);}
 /// Wrapper for MPI_Allgather (data struct)
   void Allgather(ConstData in,Data out);
 /// Wrapper for MPI_Allgatherv (pointer)
@@ -0,0 +1,231 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "DcdFile.h"
+#include "Exception.h"
+#include "Tools.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __PLUMED_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PLMD{
+
+DcdFrame::DcdFrame():
+  x(NULL),
+  y(NULL),
+  z(NULL)
+{
+  for(unsigned i=0;i<9;i++) box[i]=0.0;
+}
+
+DcdReader::DcdReader():
+  fp(NULL),
+  reverse(false),
+  hasCell(false),
+  natoms(0),
+  nframes(0),
+  headerSize(0),
+  frameSize(0),
+  map(NULL),
+  mapSize(0)
+{
+}
+
+DcdReader::~DcdReader(){
+  close();
+}
+
+int DcdReader::getInt(const char*p)const{
+  char c[4];
+  if(reverse) for(unsigned i=0;i<4;i++) c[i]=p[3-i];
+  else std::memcpy(c,p,4);
+  int i;
+  std::memcpy(&i,c,4);
+  return i;
+}
+
+double DcdReader::getDouble(const char*p)const{
+  char c[8];
+  if(reverse) for(unsigned i=0;i<8;i++) c[i]=p[7-i];
+  else std::memcpy(c,p,8);
+  double d;
+  std::memcpy(&d,c,8);
+  return d;
+}
+
+const char* DcdReader::readRaw(std::size_t offset,std::size_t n){
+  if(map) return map+offset;
+  buffer.resize(n);
+  if(std::fseek(fp,long(offset),SEEK_SET)!=0 || std::fread(&buffer[0],1,n,fp)!=n) plumed_merror("error reading file "+path);
+  return &buffer[0];
+}
+
+bool DcdReader::open(const std::string& path){
+  close();
+  fp=std::fopen(path.c_str(),"rb");
+  if(!fp) return false;
+  this->path=path;
+  std::fseek(fp,0,SEEK_END);
+  std::size_t fileSize=std::ftell(fp);
+#ifdef __PLUMED_HAS_MMAP
+  if(fileSize>0){
+// the map stays valid after the descriptor is closed
+    int fd=::open(path.c_str(),O_RDONLY);
+    if(fd>=0){
+      void* p=mmap(NULL,fileSize,PROT_READ,MAP_SHARED,fd,0);
+      ::close(fd);
+      if(p!=MAP_FAILED){
+        map=static_cast<const char*>(p);
+        mapSize=fileSize;
+// frames are not necessarily read in order, so the kernel should not read ahead
+        madvise(p,mapSize,MADV_RANDOM);
+      }
+    }
+  }
+#endif
+  readHeader(fileSize);
+  return true;
+}
+
+void DcdReader::readHeader(std::size_t fileSize){
+// first record: 84 bytes with the CORD string followed by 20 integers
+  if(fileSize<100) plumed_merror("file "+path+" is too short to be a dcd file");
+  const char* p=readRaw(0,100);
+  reverse=false;
+  if(getInt(p)!=84){
+    reverse=true;
+    if(getInt(p)!=84) plumed_merror("file "+path+" is not a dcd file or uses 64 bit record markers, which are not supported");
+  }
+  if(std::strncmp(p+4,"CORD",4)!=0) plumed_merror("file "+path+" is not a dcd file");
+  const char* icntrl=p+8;
+// a nonzero last integer identifies CHARMM files, which can carry a unit cell and a fourth dimension
+  bool charmm=(getInt(icntrl+76)!=0);
+  hasCell=charmm && getInt(icntrl+40)!=0;
+  bool has4D=charmm && getInt(icntrl+44)==1;
+  if(getInt(icntrl+32)!=0) plumed_merror("file "+path+" contains fixed atoms, which are not supported");
+  if(getInt(p+88)!=84) plumed_merror("file "+path+" has a corrupted header");
+// second record: the titles
+  std::size_t titleSize=getInt(p+92);
+  std::size_t offset=96+titleSize+4;
+  if(offset+12>fileSize) plumed_merror("file "+path+" has a corrupted header");
+  p=readRaw(offset,12);
+// third record: the number of atoms
+  if(getInt(p)!=4 || getInt(p+8)!=4) plumed_merror("file "+path+" has a corrupted header");
+  natoms=getInt(p+4);
+  if(natoms<=0) plumed_merror("file "+path+" has a corrupted header");
+  headerSize=offset+12;
+  std::size_t block=4*std::size_t(natoms)+8;
+  frameSize=(hasCell?56:0)+(has4D?4:3)*block;
+  nframes=(fileSize-headerSize)/frameSize;
+  if(nframes==0) plumed_merror("file "+path+" does not contain any complete frame");
+  p=readRaw(headerSize,frameSize);
+  if(hasCell && getInt(p)!=48) plumed_merror("file "+path+" has a corrupted unit cell record");
+  if(getInt(p+(hasCell?56:0))!=4*natoms) plumed_merror("file "+path+" has a corrupted coordinate record");
+}
+
+void DcdReader::close(){
+#ifdef __PLUMED_HAS_MMAP
+  if(map) munmap(const_cast<char*>(map),mapSize);
+#endif
+  map=NULL;
+  mapSize=0;
+  if(fp) std::fclose(fp);
+  fp=NULL;
+  natoms=0;
+  nframes=0;
+  buffer.clear();
+}
+
+int DcdReader::getNumberOfAtoms()const{
+  return natoms;
+}
+
+unsigned DcdReader::getNumberOfFrames()const{
+  return nframes;
+}
+
+void DcdReader::readFrame(unsigned i,DcdFrame& frame){
+  plumed_massert(i<nframes,"frame index out of range in file "+path);
+  const char* p=readRaw(headerSize+i*frameSize,frameSize);
+  if(hasCell){
+// A, cos(gamma), B, cos(beta), cos(alpha), C. Old files store the angles in degrees instead of their cosines
+    double cell[6];
+    for(unsigned j=0;j<6;j++) cell[j]=getDouble(p+4+8*j);
+    double cosAB=cell[1],cosAC=cell[3],cosBC=cell[4];
+    if(std::fabs(cosAB)>1.0 || std::fabs(cosAC)>1.0 || std::fabs(cosBC)>1.0){
+      cosAB=std::cos(cell[1]*pi/180.0);
+      cosAC=std::cos(cell[3]*pi/180.0);
+      cosBC=std::cos(cell[4]*pi/180.0);
+    }
+    double sinAB=std::sqrt(1.0-cosAB*cosAB);
+    double* box=frame.box;
+    box[0]=cell[0];       box[1]=0.0;            box[2]=0.0;
+    box[3]=cell[2]*cosAB; box[4]=cell[2]*sinAB;  box[5]=0.0;
+    box[6]=cell[5]*cosAC; box[7]=(cell[5]*cell[2]*cosBC-box[6]*box[3])/box[4];
+    box[8]=std::sqrt(cell[5]*cell[5]-box[6]*box[6]-box[7]*box[7]);
+    p+=56;
+  } else {
+    for(unsigned j=0;j<9;j++) frame.box[j]=0.0;
+  }
+  std::size_t block=4*std::size_t(natoms)+8;
+  if(getInt(p)!=4*natoms || getInt(p+block)!=4*natoms || getInt(p+2*block)!=4*natoms)
+    plumed_merror("file "+path+" has a corrupted coordinate record");
+  if(reverse){
+// swap the blocks in the buffer, copying them there first if the file is mapped
+    char* q;
+    if(map){
+      buffer.assign(p,p+3*block);
+      q=&buffer[0];
+    } else q=const_cast<char*>(p);
+    for(unsigned j=0;j<3;j++){
+      char* b=q+j*block+4;
+      for(int k=0;k<natoms;k++,b+=4){
+        std::swap(b[0],b[3]);
+        std::swap(b[1],b[2]);
+      }
+    }
+    p=q;
+  }
+  frame.x=reinterpret_cast<const float*>(p+4);
+  frame.y=reinterpret_cast<const float*>(p+block+4);
+  frame.z=reinterpret_cast<const float*>(p+2*block+4);
+}
+
+void DcdReader::prefetch(unsigned i)const{
+#ifdef __PLUMED_HAS_MMAP
+  if(!map || i>=nframes) return;
+  std::size_t page=sysconf(_SC_PAGESIZE);
+  std::size_t start=headerSize+i*frameSize;
+  std::size_t aligned=start-start%page;
+  madvise(const_cast<char*>(map)+aligned,start+frameSize-aligned,MADV_WILLNEED);
+#else
+  (void) i;
+#endif
+}
+
+}
@@ -0,0 +1,96 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_DcdFile_h
+#define __PLUMED_tools_DcdFile_h
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace PLMD{
+
+/// \ingroup TOOLBOX
+/// A single frame of a CHARMM/NAMD dcd trajectory.
+/// The coordinates are not copied: x, y and z point to the blocks stored in the file
+/// and remain valid until the next frame is read or the file is closed.
+/// Lengths are in Angstrom.
+class DcdFrame {
+public:
+  const float* x;
+  const float* y;
+  const float* z;
+/// Lattice vectors stored row by row, all zero if the file has no unit cell
+  double box[9];
+  DcdFrame();
+};
+
+/// \ingroup TOOLBOX
+/// Reads dcd trajectories with random access to their frames.
+/// All frames have the same size, so their offsets are computed from the header
+/// and any frame can be read with readFrame().
+/// When mmap is available the file is mapped in memory and the coordinates are
+/// used where they are, otherwise each frame is read in a buffer.
+/// Files with the opposite endianness are byte swapped in the same buffer.
+/// A truncated frame at the end of the file is ignored.
+class DcdReader {
+private:
+  std::FILE* fp;
+  std::string path;
+/// True if the file has the opposite endianness
+  bool reverse;
+/// True if each frame starts with the CHARMM unit cell block
+  bool hasCell;
+  int natoms;
+  unsigned nframes;
+  std::size_t headerSize;
+  std::size_t frameSize;
+/// Mapped file, NULL if it is read with fread
+  const char* map;
+  std::size_t mapSize;
+/// Frame read from the file or byte swapped
+  std::vector<char> buffer;
+  int getInt(const char*)const;
+  double getDouble(const char*)const;
+/// Read the header and compute the number of frames
+  void readHeader(std::size_t fileSize);
+/// Read n bytes at offset, either from the map or from the file
+  const char* readRaw(std::size_t offset,std::size_t n);
+  DcdReader(const DcdReader&);
+  DcdReader& operator=(const DcdReader&);
+public:
+  DcdReader();
+  ~DcdReader();
+/// Open a file. Returns false if the file cannot be opened
+  bool open(const std::string& path);
+  void close();
+  int getNumberOfAtoms()const;
+  unsigned getNumberOfFrames()const;
+/// Read frame i
+  void readFrame(unsigned i,DcdFrame& frame);
+/// Tell the system that frame i will be read soon, so that it can be loaded in advance
+  void prefetch(unsigned i)const;
+};
+
+}
+
+#endif
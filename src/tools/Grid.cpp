@@ -32,6 +32,7 @@
 #include "File.h"
 #include "Exception.h"
 #include "KernelFunctions.h"
+#include "Arena.h"
 
 using namespace std;
 namespace PLMD{
@@ -327,9 +328,10 @@ void Grid::addKernel( const KernelFunctions& kernel ){
   std::vector<unsigned> nneighb=kernel.getSupport( dx_ );
   std::vector<unsigned> neighbors=getNeighbors( kernel.getCenter(), nneighb );
   std::vector<double> xx( dimension_ ); std::vector<Value*> vv( dimension_ );
+  ArenaVector<Value>::type values( dimension_ );
   std::string str_min, str_max;
   for(unsigned i=0;i<dimension_;++i){
-      vv[i]=new Value();
+      vv[i]=&values[i];
       if( pbc_[i] ){
           Tools::convert(min_[i],str_min);
           Tools::convert(max_[i],str_max);
@@ -348,8 +350,6 @@ void Grid::addKernel( const KernelFunctions& kernel ){
       if( usederiv_ ) addValueAndDerivatives( ineigh, newval, der );
       else addValue( ineigh, newval );
   }
-
-  for(unsigned i=0;i<dimension_;++i) delete vv[i];
 }
 
 double Grid::getValue(unsigned index) const {
@@ -567,6 +567,10 @@ void Grid::writeToFile(OFile& ofile){
  }
 }
 
+Grid* Grid::clone() const{
+ return new Grid(*this);
+}
+
 Grid* Grid::create(const std::string& funcl, std::vector<Value*> args, IFile& ifile, 
                    const vector<std::string> & gmin,const vector<std::string> & gmax, 
                    const vector<unsigned> & nbin,bool dosparse, bool dospline, bool doder){
@@ -649,6 +653,10 @@ void SparseGrid::clear(){
  map_.clear();
 }
 
+Grid* SparseGrid::clone() const{
+ return new SparseGrid(*this);
+}
+
 unsigned SparseGrid::getSize() const{
  return map_.size(); 
 }
@@ -114,6 +114,8 @@ public:
  std::vector<bool> getIsPeriodic() const;
 /// get grid dimension
  unsigned getDimension() const;
+/// are derivatives stored on the grid
+ bool hasDerivatives() const {return usederiv_;}
 /// get argument names  of this grid 
  std::vector<std::string> getArgNames() const;
  
@@ -185,6 +187,9 @@ public:
 /// dump grid on file
  virtual void writeToFile(OFile&);
 
+/// get a copy of this grid, with the same dynamic type
+ virtual Grid* clone() const;
+
  virtual ~Grid(){}
 
 /// project a high dimensional grid onto a low dimensional one: this should be changed at some time 
@@ -241,6 +246,9 @@ class SparseGrid : public Grid
 /// dump grid on file
  void writeToFile(OFile&);
 
+/// get a copy of this grid
+ Grid* clone() const;
+
  virtual ~SparseGrid(){}
 };
 }
@@ -0,0 +1,133 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "HillIndex.h"
+#include "Exception.h"
+#include <cmath>
+#include <algorithm>
+
+namespace PLMD{
+
+HillIndex::HillIndex(const std::vector<bool>& periodic,const std::vector<double>& min,const std::vector<double>& max):
+  dimension(periodic.size()),
+  periodic(periodic),
+  pmin(min),
+  period(dimension,0.0),
+  ncells(dimension,0),
+  nfunctions(0)
+{
+  plumed_assert(min.size()==dimension && max.size()==dimension);
+  for(unsigned i=0;i<dimension;i++) if(periodic[i]){
+    period[i]=max[i]-min[i];
+    plumed_massert(period[i]>0.0,"periodic directions should have a domain of finite size");
+  }
+}
+
+void HillIndex::setupCells(const std::vector<double>& halfwidth){
+  width.resize(dimension);
+  for(unsigned i=0;i<dimension;i++){
+// cells as large as half the support: a function touches about three cells per direction
+    width[i]=halfwidth[i];
+    if(!(width[i]>0.0)) width[i]=1.0;
+    if(periodic[i]){
+      ncells[i]=static_cast<int>(std::floor(period[i]/width[i]));
+      if(ncells[i]<1) ncells[i]=1;
+      width[i]=period[i]/ncells[i];
+    }
+  }
+}
+
+int HillIndex::getUnwrappedCell(unsigned i,double x)const{
+  double y=(periodic[i]?x-pmin[i]:x)/width[i];
+// avoid overflows for points very far from the origin
+  if(y>1.0e9) y=1.0e9;
+  if(y<-1.0e9) y=-1.0e9;
+  return static_cast<int>(std::floor(y));
+}
+
+int HillIndex::wrapCell(unsigned i,int k)const{
+  if(periodic[i]){
+    k%=ncells[i];
+    if(k<0) k+=ncells[i];
+  }
+  return k;
+}
+
+void HillIndex::add(const std::vector<double>& center,const std::vector<double>& halfwidth){
+  plumed_assert(center.size()==dimension && halfwidth.size()==dimension);
+  if(width.empty()) setupCells(halfwidth);
+  unsigned id=nfunctions++;
+
+  std::vector<int> lo(dimension),span(dimension);
+  unsigned long ntot=1;
+  for(unsigned i=0;i<dimension;i++){
+// a small tolerance so that points exactly on the border of the support are not missed
+    double h=halfwidth[i]*(1.0+1.0e-6);
+    if(periodic[i] && 2.0*h>=period[i]){
+      lo[i]=0;
+      span[i]=ncells[i];
+    } else {
+      lo[i]=getUnwrappedCell(i,center[i]-h);
+      span[i]=getUnwrappedCell(i,center[i]+h)-lo[i]+1;
+      if(periodic[i] && span[i]>ncells[i]) span[i]=ncells[i];
+    }
+    ntot*=span[i];
+    if(ntot>maxcells){
+      wide.push_back(id);
+      return;
+    }
+  }
+
+// loop over all the cells in the box
+  std::vector<int> c(dimension,0);
+  Key key(dimension);
+  for(unsigned long n=0;n<ntot;n++){
+    for(unsigned i=0;i<dimension;i++){
+      key[i]=wrapCell(i,lo[i]+c[i]);
+    }
+    cells[key].push_back(id);
+    for(unsigned i=0;i<dimension;i++){
+      c[i]++;
+      if(c[i]<span[i]) break;
+      c[i]=0;
+    }
+  }
+}
+
+void HillIndex::getCandidates(const std::vector<double>& x,std::vector<unsigned>& candidates)const{
+  plumed_assert(x.size()==dimension);
+  candidates.clear();
+  const std::vector<unsigned>* incell=NULL;
+  if(!width.empty()){
+    Key key(dimension);
+    for(unsigned i=0;i<dimension;i++) key[i]=wrapCell(i,getUnwrappedCell(i,x[i]));
+    std::map<Key,std::vector<unsigned> >::const_iterator it=cells.find(key);
+    if(it!=cells.end()) incell=&(it->second);
+  }
+  if(!incell) candidates=wide;
+  else if(wide.empty()) candidates=*incell;
+  else {
+    candidates.resize(incell->size()+wide.size());
+    std::merge(incell->begin(),incell->end(),wide.begin(),wide.end(),candidates.begin());
+  }
+}
+
+}
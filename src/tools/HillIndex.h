@@ -0,0 +1,88 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_HillIndex_h
+#define __PLUMED_tools_HillIndex_h
+
+#include <vector>
+#include <map>
+
+namespace PLMD{
+
+/// \ingroup TOOLBOX
+/// A spatial index over a growing set of localized functions (e.g. Gaussian hills).
+/// Space is divided into cells whose size is taken from the first function inserted.
+/// Each function is stored in all the cells touched by the box that contains its support,
+/// so that finding the functions that might be non-zero at a point only requires one
+/// cell to be looked up. Functions whose support spans too many cells are kept in a
+/// separate list that is always returned. Periodic directions are wrapped.
+class HillIndex {
+private:
+/// The key identifying a cell
+  typedef std::vector<int> Key;
+/// Number of dimensions
+  unsigned dimension;
+/// Periodicity of each direction
+  std::vector<bool> periodic;
+/// Lower end of the domain of periodic directions
+  std::vector<double> pmin;
+/// Period of periodic directions
+  std::vector<double> period;
+/// Size of the cells in each direction (zero until the first function is inserted)
+  std::vector<double> width;
+/// Number of cells in periodic directions
+  std::vector<int> ncells;
+/// Functions stored in each cell, in order of insertion
+  std::map<Key,std::vector<unsigned> > cells;
+/// Functions that are too wide to be stored in cells
+  std::vector<unsigned> wide;
+/// Number of functions inserted so far
+  unsigned nfunctions;
+/// Maximum number of cells a single function can be stored in
+  static const unsigned maxcells=1024;
+/// Set the size of the cells
+  void setupCells(const std::vector<double>& halfwidth);
+/// Cell index along a direction, before periodic wrapping
+  int getUnwrappedCell(unsigned i,double x)const;
+/// Wrap a cell index along a periodic direction
+  int wrapCell(unsigned i,int k)const;
+public:
+/// Constructor. For each direction one should say whether it is periodic and, if so,
+/// its domain
+  HillIndex(const std::vector<bool>& periodic,const std::vector<double>& min,const std::vector<double>& max);
+/// Insert a function. Its identifier is the number of functions inserted before it.
+/// halfwidth contains, for each direction, the half size of the box outside of which
+/// the function is zero
+  void add(const std::vector<double>& center,const std::vector<double>& halfwidth);
+/// Get the identifiers of the functions that might be non-zero at x, sorted in increasing order
+  void getCandidates(const std::vector<double>& x,std::vector<unsigned>& candidates)const;
+/// Number of functions inserted
+  unsigned size()const;
+};
+
+inline
+unsigned HillIndex::size()const{
+  return nfunctions;
+}
+
+}
+
+#endif
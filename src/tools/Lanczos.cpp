@@ -0,0 +1,153 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Lanczos.h"
+#include "Random.h"
+#include "Exception.h"
+#include <cmath>
+
+namespace PLMD{
+
+/// Remove from w its projections on the first nvec vectors in basis.  
+/// This is done twice as a single pass of Gram-Schmidt is not numerically stable
+static void orthogonalize( const std::vector<std::vector<double> >& basis, const unsigned& nvec, std::vector<double>& w ){
+  for(unsigned pass=0;pass<2;++pass){
+     for(unsigned i=0;i<nvec;++i){
+        double d=0; for(unsigned k=0;k<w.size();++k) d+=basis[i][k]*w[k];
+        for(unsigned k=0;k<w.size();++k) w[k]-=d*basis[i][k];
+     }
+  }
+}
+
+static double normalize( std::vector<double>& w ){
+  double norm=0; for(unsigned k=0;k<w.size();++k) norm+=w[k]*w[k];
+  norm=sqrt(norm);
+  if( norm>0 ) for(unsigned k=0;k<w.size();++k) w[k]/=norm;
+  return norm;
+}
+
+Lanczos::Lanczos( const SymmetricOperator& myop, const double& tol ):
+op(myop),
+tolerance(tol),
+nproducts(0)
+{
+}
+
+void Lanczos::setStartingVector( const std::vector<double>& start ){
+  plumed_assert( start.size()==op.size() );
+  guess=start;
+}
+
+int Lanczos::diagonalize( const unsigned& neig, std::vector<double>& eigenvals, Matrix<double>& eigenvecs ){
+  unsigned n=op.size(); plumed_assert( neig>0 && neig<=n );
+  nproducts=0;
+
+  // A fixed seed is used so that results are reproducible
+  Random rnd; rnd.setSeed(-1);
+  std::vector<double> start( n );
+  if( guess.size()==n ) start=guess; 
+  if( normalize(start)==0 ){
+     for(unsigned k=0;k<n;++k) start[k]=rnd.U01()-0.5;
+     normalize(start);
+  }
+
+  std::vector<double> w( n ), theta; Matrix<double> S;
+  // If the starting vector is already converged there is no need to build a Krylov space
+  if( neig==1 && guess.size()==n ){
+     op.apply( start, w ); nproducts++;
+     double rayleigh=0; for(unsigned k=0;k<n;++k) rayleigh+=start[k]*w[k];
+     double res=0; for(unsigned k=0;k<n;++k) res+=(w[k]-rayleigh*start[k])*(w[k]-rayleigh*start[k]);
+     if( sqrt(res)<=tolerance*fabs(rayleigh) ){
+        eigenvals.resize( 1 ); eigenvals[0]=rayleigh;
+        eigenvecs.resize( 1, n );
+        double s=0.0; for(unsigned k=0;k<n;++k) s+=start[k];
+        for(unsigned k=0;k<n;++k) eigenvecs(0,k)=( s<0.0 ? -start[k] : start[k] );
+        return 0;
+     }
+  }
+
+  unsigned nkrylov=2*neig+20; if( nkrylov>n ) nkrylov=n;
+  while( true ){
+     std::vector<std::vector<double> > basis( nkrylov );
+     std::vector<double> alpha( nkrylov, 0.0 ), beta( nkrylov, 0.0 );
+     basis[0]=start; double anorm=0.0; unsigned m=nkrylov; 
+     for(unsigned j=0;j<nkrylov;++j){
+        op.apply( basis[j], w ); nproducts++;
+        alpha[j]=0; for(unsigned k=0;k<n;++k) alpha[j]+=basis[j][k]*w[k];
+        // Full reorthogonalization also removes the alpha and beta terms of the three term recurrence
+        orthogonalize( basis, j+1, w ); beta[j]=normalize( w ); 
+        if( fabs(alpha[j])+beta[j]>anorm ) anorm=fabs(alpha[j])+beta[j];
+        if( j+1==nkrylov ) break;
+
+        if( beta[j]<=1.0e-14*anorm ){
+           // An invariant subspace has been found so continue with a new random direction
+           beta[j]=0.0;
+           for(unsigned k=0;k<n;++k) w[k]=rnd.U01()-0.5;
+           orthogonalize( basis, j+1, w );
+           if( normalize( w )==0 ){ m=j+1; break; }
+        }
+        basis[j+1]=w;
+     }
+
+     // Diagonalize the tridiagonal matrix 
+     Matrix<double> T( m, m ); T=0.0;
+     for(unsigned j=0;j<m;++j){
+        T(j,j)=alpha[j];
+        if( j+1<m ){ T(j,j+1)=beta[j]; T(j+1,j)=beta[j]; }
+     }
+     if( diagMat( T, theta, S )!=0 ) return 1;
+     unsigned nfound=( neig<m ? neig : m );
+
+     // Check the residuals of the eigenpairs we are interested in
+     double scale=std::max( fabs(theta[0]), fabs(theta[m-1]) );
+     bool converged=true;
+     for(unsigned i=0;i<nfound;++i){
+        if( fabs( beta[m-1]*S(m-1-i,m-1) )>tolerance*scale ) converged=false;
+     }
+
+     // Compute the Ritz vectors
+     if( eigenvals.size()!=neig ) eigenvals.resize( neig );
+     if( eigenvecs.nrows()!=neig || eigenvecs.ncols()!=n ) eigenvecs.resize( neig, n );
+     eigenvecs=0.0; 
+     for(unsigned i=0;i<nfound;++i){
+        unsigned r=m-1-i; eigenvals[i]=theta[r];
+        for(unsigned j=0;j<m;++j){
+           for(unsigned k=0;k<n;++k) eigenvecs(i,k)+=S(r,j)*basis[j][k];
+        }
+        // This changes eigenvectors so that the sum of the elements is positive as is done in diagMat
+        double s=0.0;
+        for(unsigned k=0;k<n;++k) s+=eigenvecs(i,k);
+        if(s<0.0) for(unsigned k=0;k<n;++k) eigenvecs(i,k)*=-1;
+     }
+     if( converged && nfound==neig ) return 0;
+     if( nkrylov==n ) return 1;
+
+     // Restart from the sum of the current approximations to the eigenvectors in a larger space
+     for(unsigned k=0;k<n;++k){
+        start[k]=0; for(unsigned i=0;i<nfound;++i) start[k]+=eigenvecs(i,k);
+     }
+     if( normalize( start )==0 ) start=basis[0];
+     nkrylov*=2; if( nkrylov>n ) nkrylov=n;
+  }
+  return 1;
+}
+
+}
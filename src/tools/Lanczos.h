@@ -0,0 +1,88 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_Lanczos_h
+#define __PLUMED_tools_Lanczos_h
+
+#include "Matrix.h"
+#include <vector>
+
+namespace PLMD{
+
+/// \ingroup TOOLBOX
+/// A symmetric matrix that is only accessed through matrix-vector products.
+/// Inherit from this class to use the Lanczos solver on matrices that are sparse or that
+/// are never stored explicitly (e.g. a distance matrix multiplied by a centering matrix).
+class SymmetricOperator {
+public:
+  virtual ~SymmetricOperator(){}
+/// The number of rows (and columns) of the matrix
+  virtual unsigned size() const=0;
+/// Calculate y = A x
+  virtual void apply( const std::vector<double>& x, std::vector<double>& y ) const=0;
+};
+
+/// \ingroup TOOLBOX
+/// Find a few of the largest eigenvalues of a symmetric matrix and the corresponding eigenvectors.
+/// This uses the Lanczos algorithm with full reorthogonalization.  The Krylov space initially
+/// has 2*neig+20 vectors and its size is doubled until the residuals of all the required 
+/// eigenpairs are smaller than the tolerance.  The memory required is proportional to the 
+/// number of rows in the matrix times the size of the Krylov space.  When the required
+/// eigenvalues are well separated from the rest of the spectrum this is a small multiple
+/// of the number of eigenvalues required but, in the worst case, the Krylov space grows up
+/// to the size of the matrix so that memory becomes quadratic in the number of rows.
+class Lanczos {
+private:
+/// The operator we are diagonalizing
+  const SymmetricOperator& op;
+/// Tolerance on the residuals of the eigenpairs
+  double tolerance;
+/// The starting vector 
+  std::vector<double> guess;
+/// The number of products with the operator that were done in the last call to diagonalize
+  unsigned nproducts;
+public:
+  explicit Lanczos( const SymmetricOperator& myop, const double& tol=1.0e-10 );
+/// Set the vector from which the iteration is started.  By default a random vector is used.
+/// If a good approximation to the leading eigenvector is known (e.g. the result of a 
+/// previous calculation) convergence is much faster.  When a single eigenpair is required and 
+/// the residual of this vector is already below the tolerance, it is returned with a single 
+/// product with the operator.  It is then up to the caller to make sure that it is the leading 
+/// eigenvector and not another one, e.g. because the matrix has changed very little since the 
+/// previous calculation.
+  void setStartingVector( const std::vector<double>& start );
+/// Calculate the neig largest eigenvalues and the corresponding eigenvectors. 
+/// Eigenvalues are returned in descending order and, like in diagMat, eigenvectors are stored 
+/// ROW-WISE so eigenvecs(i,j) is the j-th component of the i-th eigenvector.  A non-zero value 
+/// is returned if the required tolerance was not reached.
+  int diagonalize( const unsigned& neig, std::vector<double>& eigenvals, Matrix<double>& eigenvecs );
+/// Get the number of matrix vector products that were required in the last calculation
+  unsigned getNumberOfProducts() const ;
+};
+
+inline
+unsigned Lanczos::getNumberOfProducts() const {
+  return nproducts;
+}
+
+}
+
+#endif
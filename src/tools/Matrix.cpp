@@ -0,0 +1,73 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Matrix.h"
+#ifdef __PLUMED_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace PLMD{
+
+#ifdef __PLUMED_HAS_PTHREAD
+static pthread_key_t workspaceKey;
+static pthread_once_t workspaceOnce=PTHREAD_ONCE_INIT;
+
+static void deleteWorkspace( void* ws ){
+  delete static_cast<LapackWorkspace*>( ws );
+}
+
+static void createWorkspaceKey(){
+  pthread_key_create( &workspaceKey, deleteWorkspace );
+}
+
+LapackWorkspace& LapackWorkspace::get(){
+  pthread_once( &workspaceOnce, createWorkspaceKey );
+  LapackWorkspace* ws=static_cast<LapackWorkspace*>( pthread_getspecific( workspaceKey ) );
+  if( !ws ){ ws=new LapackWorkspace; pthread_setspecific( workspaceKey, ws ); }
+  return *ws;
+}
+#else
+LapackWorkspace& LapackWorkspace::get(){
+  static LapackWorkspace ws;
+  return ws;
+}
+#endif
+
+bool LapackWorkspace::getOptimalSizes( const Routine& r, const int& nr, const int& nc, int& lwork, int& liwork ) const {
+  std::map< std::pair<int,std::pair<int,int> >, std::pair<int,int> >::const_iterator it;
+  it=optimal.find( std::make_pair( static_cast<int>(r), std::make_pair(nr,nc) ) );
+  if( it==optimal.end() ) return false;
+  lwork=it->second.first; liwork=it->second.second;
+  return true;
+}
+
+void LapackWorkspace::trim(){
+  shrink( da ); shrink( evals ); shrink( evecs ); shrink( vt );
+  shrink( work ); shrink( iwork ); shrink( isup );
+}
+
+void LapackWorkspace::setOptimalSizes( const Routine& r, const int& nr, const int& nc, const int& lwork, const int& liwork ){
+  // Matrices of many different sizes should not make the table grow without bound
+  if( optimal.size()>=64 ) optimal.clear();
+  optimal[ std::make_pair( static_cast<int>(r), std::make_pair(nr,nc) ) ]=std::make_pair( lwork, liwork );
+}
+
+}
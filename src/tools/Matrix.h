@@ -24,6 +24,7 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
 #include <cmath>
 #include "Exception.h"
 #include "MatrixSquareBracketsAccess.h"
@@ -46,6 +47,53 @@ template <typename T> T norm( const std::vector<T>& A ){
    return val;
 }
 
+/// \ingroup TOOLBOX
+/// Work arrays for the LAPACK routines that are called by the functions in Matrix.h.
+/// The arrays are kept between calls so memory is only allocated when a matrix larger than 
+/// those seen before is used.  Arrays that grow beyond maxRetained elements are released once the 
+/// call that needed them returns, so a single large matrix does not pin its memory for the rest of the run.  The optimal sizes of the work arrays are also stored so the LAPACK
+/// workspace query is only done once for each routine and matrix size.  Each thread has its own workspace.
+class LapackWorkspace {
+private:
+/// Optimal sizes of the double and integer work arrays for each routine and matrix size
+  std::map< std::pair<int,std::pair<int,int> >, std::pair<int,int> > optimal;
+/// Release an array if it holds more than maxRetained elements
+  template <typename U> static void shrink( std::vector<U>& v ){
+    if( v.capacity()>maxRetained ) std::vector<U>().swap( v );
+  }
+public:
+/// The largest number of elements an array keeps between calls
+  static const unsigned maxRetained=1<<20;
+/// Calls trim on a workspace when it goes out of scope
+  class Trimmer {
+  private:
+    LapackWorkspace& ws;
+  public:
+    explicit Trimmer( LapackWorkspace& w ) : ws(w) {}
+    ~Trimmer(){ ws.trim(); }
+  };
+/// The routines whose optimal work sizes are stored
+  enum Routine { dsyevrV, dsyevrN, dgetri, dgesdd };
+/// Arrays used to store the matrices passed to LAPACK
+  std::vector<double> da, evals, evecs, vt;
+/// The work arrays
+  std::vector<double> work;
+  std::vector<int> iwork, isup;
+/// Get the workspace for the calling thread
+  static LapackWorkspace& get();
+/// Release the arrays that are larger than maxRetained
+  void trim();
+/// Make sure the array has at least n elements and return a pointer to its first element 
+  template <typename U> static U* reserve( std::vector<U>& v, const unsigned& n ){
+    if( v.size()<n || v.empty() ) v.resize( n>0 ? n : 1 );
+    return &v[0];
+  }
+/// Retrieve the optimal sizes of the work arrays for a routine acting on an nr x nc matrix.  Returns false if they have not been stored yet
+  bool getOptimalSizes( const Routine& r, const int& nr, const int& nc, int& lwork, int& liwork ) const ;
+/// Store the optimal sizes of the work arrays for a routine acting on an nr x nc matrix
+  void setOptimalSizes( const Routine& r, const int& nr, const int& nc, const int& lwork, const int& liwork );
+};
+
 /// This class stores a full matrix and allows one to do some simple matrix operations
 template <typename T>
 class Matrix:
@@ -161,24 +209,60 @@ template <typename T> Matrix<T> operator*(T& v, const Matrix<T>& m ){
   return new_m; 
 }
 
+/// Product of two n x n matrices stored row-wise.  As n is a template parameter the loops 
+/// are unrolled by the compiler so this is used for the 3x3 and 4x4 matrices that are very common
+template <unsigned n, typename T> void multSmall( const T* a, const T* b, T* c ){
+  for(unsigned i=0;i<n;++i) for(unsigned j=0;j<n;++j){
+     T tmp=static_cast<T>( 0 );
+     for(unsigned k=0;k<n;++k) tmp+=a[i*n+k]*b[k*n+j];
+     c[i*n+j]=tmp;
+  }
+}
+
 template <typename T> void mult( const Matrix<T>& A , const Matrix<T>& B , Matrix<T>& C ){
   plumed_assert(A.cl==B.rw);
   if( A.rw !=C.rw  || B.cl !=C.cl ){ C.resize( A.rw , B.cl ); } C=static_cast<T>( 0 ); 
-  for(unsigned i=0;i<A.rw;++i) for(unsigned j=0;j<B.cl;++j) for (unsigned k=0; k<A.cl; ++k) C(i,j)+=A(i,k)*B(k,j); 
+  if( C.sz==0 || A.cl==0 ) return;
+  const T* a=&A.data[0]; const T* b=&B.data[0]; T* c=&C.data[0];
+  if( A.rw==3 && A.cl==3 && B.cl==3 ){ multSmall<3>( a, b, c ); return; }
+  if( A.rw==4 && A.cl==4 && B.cl==4 ){ multSmall<4>( a, b, c ); return; }
+  // The loops are blocked so that the rows of the blocks of B and C that are in use stay in cache. 
+  // Each element of C is still accumulated in order of increasing k so the result does not depend on the block size
+  const unsigned bs=64;
+  for(unsigned kk=0;kk<A.cl;kk+=bs){
+     unsigned kend=( kk+bs<A.cl ? kk+bs : A.cl );
+     for(unsigned jj=0;jj<B.cl;jj+=bs){
+        unsigned jend=( jj+bs<B.cl ? jj+bs : B.cl );
+        for(unsigned i=0;i<A.rw;++i){
+           T* ci=c+i*C.cl; const T* ai=a+i*A.cl;
+           for(unsigned k=kk;k<kend;++k){
+              const T aik=ai[k]; const T* bk=b+k*B.cl;
+              for(unsigned j=jj;j<jend;++j) ci[j]+=aik*bk[j];
+           }
+        }
+     }
+  }
 }
 
 template <typename T> void mult( const Matrix<T>& A, const std::vector<T>& B, std::vector<T>& C){
   plumed_assert( A.cl==B.size() );
   if( C.size()!=A.rw  ){ C.resize(A.rw); } 
-  for(unsigned i=0;i<A.rw;++i){ C[i]= static_cast<T>( 0 ); }
-  for(unsigned i=0;i<A.rw;++i) for(unsigned k=0;k<A.cl;++k) C[i]+=A(i,k)*B[k] ;
+  for(unsigned i=0;i<A.rw;++i){
+     const T* ai=( A.cl>0 ? &A.data[i*A.cl] : NULL ); T tmp=static_cast<T>( 0 );
+     for(unsigned k=0;k<A.cl;++k) tmp+=ai[k]*B[k];
+     C[i]=tmp;
+  }
 }
 
 template <typename T> void mult( const std::vector<T>& A, const Matrix<T>& B, std::vector<T>& C){
   plumed_assert( B.rw==A.size() );
   if( C.size()!=B.cl ){C.resize( B.cl );} 
   for(unsigned i=0;i<B.cl;++i){ C[i]=static_cast<T>( 0 ); }
-  for(unsigned i=0;i<B.cl;++i) for(unsigned k=0;k<B.rw;++k) C[i]+=A[k]*B(k,i); 
+  // Loop over the rows of B so that memory is accessed contiguously
+  for(unsigned k=0;k<B.rw;++k){
+     const T ak=A[k]; const T* bk=&B.data[k*B.cl];
+     for(unsigned i=0;i<B.cl;++i) C[i]+=ak*bk[i];
+  }
 }
 
 template <typename T> void transpose( const Matrix<T>& A, Matrix<T>& AT ){
@@ -203,23 +287,27 @@ template <typename T> int diagMat( const Matrix<T>& A, std::vector<double>& eige
 
    // Check matrix is square and symmetric 
    plumed_assert( A.rw==A.cl ); plumed_assert( A.isSymmetric()==1 );
-   double *da=new double[A.sz]; unsigned k=0; double *evals=new double[ A.cl ];
+   LapackWorkspace& ws( LapackWorkspace::get() ); LapackWorkspace::Trimmer trimmer( ws );
+   double *da=LapackWorkspace::reserve( ws.da, A.sz ); unsigned k=0; 
+   double *evals=LapackWorkspace::reserve( ws.evals, A.cl );
    // Transfer the matrix to the local array
    for (unsigned i=0; i<A.cl; ++i) for (unsigned j=0; j<A.rw; ++j) da[k++]=static_cast<double>( A(j,i) );
 
-   int n=A.cl; int lwork=-1, liwork=-1, m, info, one=1;
-   double *work=new double[A.cl]; int *iwork=new int[A.cl];
+   int n=A.cl; int lwork, liwork, m, info, one=1;
    double vl, vu, abstol=0.0;
-   int* isup=new int[2*A.cl]; double *evecs=new double[A.sz];
-
-   plumed_lapack_dsyevr("V", "I", "U", &n, da, &n, &vl, &vu, &one, &n ,
-                            &abstol, &m, evals, evecs, &n,
-                            isup, work, &lwork, iwork, &liwork, &info);
-   if (info!=0) return info;
-
-   // Retrieve correct sizes for work and iwork then reallocate
-   liwork=iwork[0]; delete [] iwork; iwork=new int[liwork];
-   lwork=static_cast<int>( work[0] ); delete [] work; work=new double[lwork];
+   int* isup=LapackWorkspace::reserve( ws.isup, 2*A.cl ); double *evecs=LapackWorkspace::reserve( ws.evecs, A.sz );
+
+   // Retrieve correct sizes for work and iwork the first time a matrix of this size is diagonalized
+   if( !ws.getOptimalSizes( LapackWorkspace::dsyevrV, n, n, lwork, liwork ) ){
+      lwork=-1; liwork=-1; double wquery; int iwquery;
+      plumed_lapack_dsyevr("V", "I", "U", &n, da, &n, &vl, &vu, &one, &n ,
+                               &abstol, &m, evals, evecs, &n,
+                               isup, &wquery, &lwork, &iwquery, &liwork, &info);
+      if (info!=0) return info;
+      lwork=static_cast<int>( wquery ); liwork=iwquery;
+      ws.setOptimalSizes( LapackWorkspace::dsyevrV, n, n, lwork, liwork );
+   }
+   double *work=LapackWorkspace::reserve( ws.work, lwork ); int *iwork=LapackWorkspace::reserve( ws.iwork, liwork );
 
    plumed_lapack_dsyevr("V", "I", "U", &n, da, &n, &vl, &vu, &one, &n ,
                             &abstol, &m, evals, evecs, &n,
@@ -245,14 +333,12 @@ template <typename T> int diagMat( const Matrix<T>& A, std::vector<double>& eige
      for(unsigned j=0;j<n;++j) s+=eigenvecs(i,j);
      if(s<0.0) for(unsigned j=0;j<n;++j) eigenvecs(i,j)*=-1;
    }
-
-   // Deallocate all the memory used by the various arrays
-   delete[] da; delete [] work; delete [] evals; delete[] evecs; delete [] iwork; delete [] isup;
    return 0;
 }
 
 template <typename T> int pseudoInvert( const Matrix<T>& A, Matrix<double>& pseudoinverse ){
-  double *da=new double[A.sz]; unsigned k=0; 
+  LapackWorkspace& ws( LapackWorkspace::get() ); LapackWorkspace::Trimmer trimmer( ws );
+  double *da=LapackWorkspace::reserve( ws.da, A.sz ); unsigned k=0; 
   // Transfer the matrix to the local array
   for (unsigned i=0; i<A.cl; ++i) for (unsigned j=0; j<A.rw; ++j) da[k++]=static_cast<double>( A(j,i) );
 
@@ -260,16 +346,19 @@ template <typename T> int pseudoInvert( const Matrix<T>& A, Matrix<double>& pseu
   if(A.rw>A.cl){nsv=A.cl;}else{nsv=A.rw;}
 
   // Create some containers for stuff from single value decomposition
-  double *S=new double[nsv]; double *U=new double[nrows*nrows];
-  double *VT=new double[ncols*ncols]; int *iwork=new int[8*nsv];
+  double *S=LapackWorkspace::reserve( ws.evals, nsv ); double *U=LapackWorkspace::reserve( ws.evecs, nrows*nrows );
+  double *VT=LapackWorkspace::reserve( ws.vt, ncols*ncols ); int *iwork=LapackWorkspace::reserve( ws.iwork, 8*nsv );
 
   // This optimizes the size of the work array used in lapack singular value decomposition
-  int lwork=-1; double* work=new double[1];
-  plumed_lapack_dgesdd( "A", &nrows, &ncols, da, &nrows, S, U, &nrows, VT, &ncols, work, &lwork, iwork, &info );
-  if(info!=0) return info;
-
-  // Retrieve correct sizes for work and rellocate
-  lwork=(int) work[0]; delete [] work; work=new double[lwork];
+  int lwork, liwork;
+  if( !ws.getOptimalSizes( LapackWorkspace::dgesdd, nrows, ncols, lwork, liwork ) ){
+     lwork=-1; double wquery;
+     plumed_lapack_dgesdd( "A", &nrows, &ncols, da, &nrows, S, U, &nrows, VT, &ncols, &wquery, &lwork, iwork, &info );
+     if(info!=0) return info;
+     lwork=(int) wquery; liwork=8*nsv;
+     ws.setOptimalSizes( LapackWorkspace::dgesdd, nrows, ncols, lwork, liwork );
+  }
+  double* work=LapackWorkspace::reserve( ws.work, lwork );
 
   // This does the singular value decomposition
   plumed_lapack_dgesdd( "A", &nrows, &ncols, da, &nrows, S, U, &nrows, VT, &ncols, work, &lwork, iwork, &info );
@@ -290,9 +379,6 @@ template <typename T> int pseudoInvert( const Matrix<T>& A, Matrix<double>& pseu
   // And do matrix algebra to construct the pseudoinverse
   if( pseudoinverse.rw!=ncols || pseudoinverse.cl!=nrows ) pseudoinverse.resize( ncols, nrows );
   mult( V, Si, tmp ); mult( tmp, UT, pseudoinverse );
-
-  // Deallocate all the memory
-  delete [] S; delete [] U; delete [] VT; delete [] work; delete [] iwork; delete [] da;
   return 0;
 }
 
@@ -308,25 +394,28 @@ template <typename T> int Invert( const Matrix<T>& A, Matrix<double>& inverse ){
      for (unsigned i=0; i<A.rw; ++i) for (unsigned j=0; j<A.cl; ++j) tevec(i,j)=evec(j,i)/eval[j];
      mult(tevec,evec,inverse);
   } else {
-     double *da=new double[A.sz]; int *ipiv=new int[A.cl];
+     LapackWorkspace& ws( LapackWorkspace::get() ); LapackWorkspace::Trimmer trimmer( ws );
+     double *da=LapackWorkspace::reserve( ws.da, A.sz ); int *ipiv=LapackWorkspace::reserve( ws.isup, A.cl );
      unsigned k=0; int n=A.rw, info;
      for(unsigned i=0;i<A.cl;++i) for(unsigned j=0;j<A.rw;++j) da[k++]=static_cast<double>( A(j,i) );
 
      plumed_lapack_dgetrf(&n,&n,da,&n,ipiv,&info);
      if(info!=0) return info;
 
-     int lwork=-1; double* work=new double[A.cl];
-     plumed_lapack_dgetri(&n,da,&n,ipiv,work,&lwork,&info);
-     if(info!=0) return info;
-
-     lwork=static_cast<int>( work[0] ); delete [] work; work=new double[lwork];
+     int lwork, liwork;
+     if( !ws.getOptimalSizes( LapackWorkspace::dgetri, n, n, lwork, liwork ) ){
+        lwork=-1; double wquery;
+        plumed_lapack_dgetri(&n,da,&n,ipiv,&wquery,&lwork,&info);
+        if(info!=0) return info;
+        lwork=static_cast<int>( wquery ); liwork=0;
+        ws.setOptimalSizes( LapackWorkspace::dgetri, n, n, lwork, liwork );
+     }
+     double* work=LapackWorkspace::reserve( ws.work, lwork );
      plumed_lapack_dgetri(&n,da,&n,ipiv,work,&lwork,&info);
      if(info!=0) return info;
 
      if( inverse.cl!=A.cl || inverse.rw!=A.rw ){ inverse.resize(A.rw,A.cl); }
      k=0; for(unsigned i=0;i<A.rw;++i) for(unsigned j=0;j<A.cl;++j) inverse(j,i)=da[k++];
-
-     delete[] work; delete[] ipiv;
   }
 
   return 0;
@@ -368,22 +457,26 @@ template <typename T> int logdet( const Matrix<T>& M, double& ldet ){
    // Check matrix is square and symmetric
    plumed_assert( M.rw==M.cl || M.isSymmetric() );
 
-   double *da=new double[M.sz]; unsigned k=0; double *evals=new double[M.cl];
+   LapackWorkspace& ws( LapackWorkspace::get() ); LapackWorkspace::Trimmer trimmer( ws );
+   double *da=LapackWorkspace::reserve( ws.da, M.sz ); unsigned k=0; 
+   double *evals=LapackWorkspace::reserve( ws.evals, M.cl );
    // Transfer the matrix to the local array
    for (unsigned i=0; i<M.rw; ++i) for (unsigned j=0; j<M.cl; ++j) da[k++]=static_cast<double>( M(j,i) );
 
-   int n=M.cl; int lwork=-1, liwork=-1, info, m, one=1;
-   double *work=new double[M.rw]; int *iwork=new int[M.rw];
+   int n=M.cl; int lwork, liwork, info, m, one=1;
    double vl, vu, abstol=0.0;
-   int* isup=new int[2*M.rw]; double *evecs=new double[M.sz];
-   plumed_lapack_dsyevr("N", "I", "U", &n, da, &n, &vl, &vu, &one, &n ,
-                            &abstol, &m, evals, evecs, &n,
-                            isup, work, &lwork, iwork, &liwork, &info);
-   if (info!=0) return info;
-
-   // Retrieve correct sizes for work and iwork then reallocate
-   lwork=static_cast<int>( work[0] ); delete [] work; work=new double[lwork];
-   liwork=iwork[0]; delete [] iwork; iwork=new int[liwork];
+   int* isup=LapackWorkspace::reserve( ws.isup, 2*M.rw ); double *evecs=LapackWorkspace::reserve( ws.evecs, M.sz );
+   // Retrieve correct sizes for work and iwork the first time a matrix of this size is used
+   if( !ws.getOptimalSizes( LapackWorkspace::dsyevrN, n, n, lwork, liwork ) ){
+      lwork=-1; liwork=-1; double wquery; int iwquery;
+      plumed_lapack_dsyevr("N", "I", "U", &n, da, &n, &vl, &vu, &one, &n ,
+                               &abstol, &m, evals, evecs, &n,
+                               isup, &wquery, &lwork, &iwquery, &liwork, &info);
+      if (info!=0) return info;
+      lwork=static_cast<int>( wquery ); liwork=iwquery;
+      ws.setOptimalSizes( LapackWorkspace::dsyevrN, n, n, lwork, liwork );
+   }
+   double *work=LapackWorkspace::reserve( ws.work, lwork ); int *iwork=LapackWorkspace::reserve( ws.iwork, liwork );
 
    plumed_lapack_dsyevr("N", "I", "U", &n, da, &n, &vl, &vu, &one, &n ,
                             &abstol, &m, evals, evecs, &n,
@@ -393,9 +486,6 @@ template <typename T> int logdet( const Matrix<T>& M, double& ldet ){
    // Transfer the eigenvalues and eigenvectors to the output 
    ldet=0; for(unsigned i=0;i<M.cl;i++){ ldet+=log(evals[i]); }
 
-   // Deallocate all the memory used by the various arrays
-   delete[] da; delete [] work; delete [] evals; delete[] evecs; delete [] iwork; delete [] isup;
-
    return 0;
 }
 
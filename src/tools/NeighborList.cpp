@@ -34,7 +34,7 @@ NeighborList::NeighborList(const vector<AtomNumber>& list0, const vector<AtomNum
                            const bool& do_pair, const bool& do_pbc, const Pbc& pbc,
                            const double& distance, const unsigned& stride): reduced(false),
                            do_pair_(do_pair), do_pbc_(do_pbc), pbc_(&pbc),
-                           distance_(distance), stride_(stride)
+                           distance_(distance), stride_(stride), skin_(0.0)
 {
 // store full list of atoms needed
  fullatomlist_=list0;
@@ -56,7 +56,7 @@ NeighborList::NeighborList(const vector<AtomNumber>& list0, const bool& do_pbc,
                            const Pbc& pbc, const double& distance,
                            const unsigned& stride): reduced(false),
                            do_pbc_(do_pbc), pbc_(&pbc),
-                           distance_(distance), stride_(stride){
+                           distance_(distance), stride_(stride), skin_(0.0){
  fullatomlist_=list0;
  nlist0_=list0.size();
  twolists_=false;
@@ -96,22 +96,51 @@ void NeighborList::update(const vector<Vector>& positions) {
  const double d2=distance_*distance_;
 // check if positions array has the correct length 
  plumed_assert(positions.size()==fullatomlist_.size());
- for(unsigned int i=0;i<nallpairs_;++i){
-   pair<unsigned,unsigned> index=getIndexPair(i);
-   unsigned index0=index.first;
-   unsigned index1=index.second;
-   Vector distance;
-   if(do_pbc_){
-    distance=pbc_->distance(positions[index0],positions[index1]);
-   } else {
-    distance=delta(positions[index0],positions[index1]);
+ const unsigned nblock=512;
+ vector<pair<unsigned,unsigned> > indexes(nblock);
+ vector<Vector> distances(nblock);
+// pairs are processed in blocks, so that pbc can be applied with a single call
+ for(unsigned int i=0;i<nallpairs_;i+=nblock){
+   unsigned nb=nblock;
+   if(i+nb>nallpairs_) nb=nallpairs_-i;
+   for(unsigned k=0;k<nb;++k){
+     indexes[k]=getIndexPair(i+k);
+     distances[k]=delta(positions[indexes[k].first],positions[indexes[k].second]);
+   }
+   if(do_pbc_) pbc_->apply(distances,nb);
+   for(unsigned k=0;k<nb;++k){
+     double value=modulo2(distances[k]);
+     if(value<=d2) {neighbors_.push_back(indexes[k]);}
    }
-   double value=modulo2(distance);
-   if(value<=d2) {neighbors_.push_back(index);} 
  }
+ if(skin_>0.0) reference_=positions;
  setRequestList();
 }
 
+void NeighborList::setSkin(double skin) {
+ plumed_massert(skin>0.0 && skin<distance_,"the skin should be positive and smaller than the neighbor list cutoff");
+ skin_=skin;
+ reference_.clear();
+}
+
+bool NeighborList::needsUpdate(const vector<Vector>& positions) const {
+ plumed_assert(skin_>0.0);
+ if(reference_.empty()) return true;
+ plumed_assert(positions.size()==reference_.size());
+ const double max2=0.25*skin_*skin_;
+ const unsigned nblock=512;
+ vector<Vector> displacements(nblock);
+// displacements are processed in blocks, as the distances in update()
+ for(unsigned i=0;i<positions.size();i+=nblock){
+   unsigned nb=nblock;
+   if(i+nb>positions.size()) nb=positions.size()-i;
+   for(unsigned k=0;k<nb;++k) displacements[k]=delta(reference_[i+k],positions[i+k]);
+   if(do_pbc_) pbc_->apply(displacements,nb);
+   for(unsigned k=0;k<nb;++k) if(modulo2(displacements[k])>max2) return true;
+ }
+ return false;
+}
+
 void NeighborList::setRequestList() {
  requestlist_.clear();
  for(unsigned int i=0;i<size();++i){
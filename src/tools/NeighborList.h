@@ -42,6 +42,10 @@ class NeighborList
   std::vector<std::pair<unsigned,unsigned> > neighbors_;
   double distance_;
   unsigned stride_,nlist0_,nlist1_,nallpairs_,lastupdate_;
+/// Verlet skin (zero if displacements are not tracked)
+  double skin_;
+/// Positions of the full list of atoms at the last update
+  std::vector<PLMD::Vector> reference_;
 /// Initialize the neighbor list with all possible pairs
   void initialize();
 /// Return the pair of indexes in the positions array
@@ -66,6 +70,14 @@ public:
 /// Update the neighbor list and prepare the new
 /// list of atoms that will be requested to the main code  
   void update(const std::vector<PLMD::Vector>& positions);
+/// Track the displacements of the atoms since the last update.
+/// The list should then be built with a cutoff equal to the interaction cutoff
+/// plus skin, and it remains valid as long as no atom moved by more than skin/2
+  void setSkin(double skin);
+/// Check if the list has to be updated, i.e. if it has never been built or
+/// if some atom moved by more than half the skin since the last update.
+/// positions should contain the full list of atoms
+  bool needsUpdate(const std::vector<PLMD::Vector>& positions) const;
 /// Get the update stride of the neighbor list
   unsigned getStride() const;
 /// Get the last step in which the neighbor list was updated  
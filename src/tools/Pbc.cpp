@@ -155,50 +155,93 @@ double Pbc::distance( const bool pbc, const Vector& v1, const Vector& v2 ) const
   else{ return ( delta(v1,v2) ).modulo(); }
 }
 
-Vector Pbc::distance(const Vector&v1,const Vector&v2,int*nshifts)const{
-  Vector d=delta(v1,v2);
-  if(type==unset){
-  } else if(type==orthorombic) {
-   for(int i=0;i<3;i++) d[i]=Tools::pbc(d[i]*invBox(i,i))*box(i,i);
+void Pbc::applyOrthorombic(Vector*d,unsigned n)const{
+// local copies, so that the compiler knows they do not alias d
+  const double b0=box(0,0),b1=box(1,1),b2=box(2,2);
+  const double i0=invBox(0,0),i1=invBox(1,1),i2=invBox(2,2);
+  for(unsigned k=0;k<n;k++){
+    double*p=&d[k][0];
+    p[0]=Tools::pbc(p[0]*i0)*b0;
+    p[1]=Tools::pbc(p[1]*i1)*b1;
+    p[2]=Tools::pbc(p[2]*i2)*b2;
+  }
 // this is another possibility:
 //   for(unsigned i=0;i<3;i++){
 //     while(d[i]>hdiag[i]) d[i]-=diag[i];
 //     while(d[i]<=mdiag[i]) d[i]+=diag[i];
 //   }
-  } else if(type==generic) {
-    Vector s=matmul(d,invReduced);
+}
+
+void Pbc::applyGeneric(Vector&d,int*nshifts)const{
+  Vector s=matmul(d,invReduced);
 // check if images have to be computed:
 //    if((std::fabs(s[0])+std::fabs(s[1])+std::fabs(s[2])>0.5)){
 // NOTICE: the check in the previous line, albeit correct, is breaking many regtest
 //         since it does not apply Tools::pbc in many cases. Moreover, it does not
 //         introduce a significant gain. I thus leave it out for the moment.
-      if(true){
 // bring to -0.5,+0.5 region in scaled coordinates:
-      for(int i=0;i<3;i++) s[i]=Tools::pbc(s[i]);
-      d=matmul(s,reduced);
+  for(int i=0;i<3;i++) s[i]=Tools::pbc(s[i]);
+  d=matmul(s,reduced);
 // check if shifts have to be attempted:
-      if((std::fabs(s[0])+std::fabs(s[1])+std::fabs(s[2])>0.5)){
+  if((std::fabs(s[0])+std::fabs(s[1])+std::fabs(s[2])>0.5)){
 // list of shifts is specific for that "octant" (depends on signs of s[i]):
-        const std::vector<Vector> & myshifts(shifts[(s[0]>0?1:0)][(s[1]>0?1:0)][(s[2]>0?1:0)]);
-        Vector best(d);
-        double lbest(modulo2(best));
+    const std::vector<Vector> & myshifts(shifts[(s[0]>0?1:0)][(s[1]>0?1:0)][(s[2]>0?1:0)]);
+    Vector best(d);
+    double lbest(modulo2(best));
 // loop over possible shifts:
-        if(nshifts) *nshifts+=myshifts.size();
-        for(unsigned i=0;i<myshifts.size();i++){
-          Vector trial=d+myshifts[i];
-          double ltrial=modulo2(trial);
-          if(ltrial<lbest){
-            lbest=ltrial;
-            best=trial;
-          }
-        }
-        d=best;
+    if(nshifts) *nshifts+=myshifts.size();
+    for(unsigned i=0;i<myshifts.size();i++){
+      Vector trial=d+myshifts[i];
+      double ltrial=modulo2(trial);
+      if(ltrial<lbest){
+        lbest=ltrial;
+        best=trial;
       }
     }
+    d=best;
+  }
+}
+
+Vector Pbc::distance(const Vector&v1,const Vector&v2,int*nshifts)const{
+  Vector d=delta(v1,v2);
+  if(type==unset){
+  } else if(type==orthorombic) {
+    applyOrthorombic(&d,1);
+  } else if(type==generic) {
+    applyGeneric(d,nshifts);
   } else plumed_merror("unknown pbc type");
   return d;
 }
 
+void Pbc::apply(std::vector<Vector>&dlist, unsigned max_index)const{
+  if(max_index==0) max_index=dlist.size();
+  plumed_dbg_assert(max_index<=dlist.size());
+  if(max_index==0) return;
+  apply(&dlist[0],max_index);
+}
+
+void Pbc::apply(Vector*dlist, unsigned n)const{
+  if(type==unset){
+  } else if(type==orthorombic) {
+    applyOrthorombic(dlist,n);
+  } else if(type==generic) {
+    for(unsigned k=0;k<n;k++) applyGeneric(dlist[k],NULL);
+  } else plumed_merror("unknown pbc type");
+}
+
+void Pbc::distances(const std::vector<Vector>&v1,const std::vector<Vector>&v2,std::vector<Vector>&d)const{
+  plumed_assert(v1.size()==v2.size());
+  d.resize(v1.size());
+  for(unsigned k=0;k<d.size();k++) d[k]=delta(v1[k],v2[k]);
+  apply(d);
+}
+
+void Pbc::distances(const std::vector<Vector>&pos,const std::vector<std::pair<unsigned,unsigned> >&pairs,std::vector<Vector>&d)const{
+  d.resize(pairs.size());
+  for(unsigned k=0;k<d.size();k++) d[k]=delta(pos[pairs[k].first],pos[pairs[k].second]);
+  apply(d);
+}
+
 Vector Pbc::realToScaled(const Vector&d)const{
   return matmul(invBox.transpose(),d);
 }
@@ -296,12 +339,15 @@ void Pbc::test(){
     std::cerr<<"\n";
     int nshifts=0;
     int ntot=10000;
+    std::vector<Vector> batch(ntot),single(ntot);
     for(int j=0;j<ntot;j++){
       Vector v(r.U01()-0.5,r.U01()-0.5,r.U01()-0.5);
       v*=5;
       for(int j=0;j<3;j++) if(r.U01()>0.2) v(j)=0.0;
       Vector full(v);
       Vector fast=pbc.distance(Vector(0,0,0),v,&nshifts);
+      batch[j]=v;
+      single[j]=fast;
       full=fast;
 
       pbc.fullSearch(full);
@@ -314,6 +360,9 @@ void Pbc::test(){
         if(std::fabs(modulo2(fast)-modulo2(full))>1e-15) plumed_error();
      }
     }
+// the batched version should give exactly the same result
+    pbc.apply(batch);
+    for(int j=0;j<ntot;j++) if(modulo2(batch[j]-single[j])>0.0) plumed_error();
     std::cerr<<"Average number of shifts: "<<double(nshifts)/double(ntot)<<"\n";
   }
 }
@@ -26,6 +26,7 @@
 #include "Tensor.h"
 #include <vector>
 #include <cstddef>
+#include <utility>
 
 namespace PLMD{
 
@@ -62,6 +63,16 @@ class Pbc{
 /// depending on the sign of the scaled coordinates representing
 /// a distance vector.
   void buildShifts(std::vector<Vector> shifts[2][2][2])const;
+/// Kernel for orthorombic cells.
+/// Applies minimal image to n contiguous distance vectors.
+/// It does not branch on the cell type and is written so that the
+/// compiler can vectorize the loop over components.
+  void applyOrthorombic(Vector*d,unsigned n)const;
+/// Kernel for generic (triclinic) cells.
+/// Applies minimal image to a single distance vector, using the
+/// reduced cell and the list of shifts. Optionally counts the
+/// attempted shifts.
+  void applyGeneric(Vector&d,int*nshifts)const;
 public:
 /// Perform some check. Useful for debugging.
   static void test();
@@ -74,6 +85,19 @@ public:
 /// version of distance which also returns the number
 /// of attempted shifts
   Vector distance(const Vector&,const Vector&,int*nshifts)const;
+/// Apply minimal image convention to a list of distance vectors, in place.
+/// Only the first max_index elements are processed (all of them if max_index==0).
+/// The check on the cell type is done once for the whole list, so this
+/// should be preferred to distance() in loops over many pairs.
+  void apply(std::vector<Vector>&dlist, unsigned max_index=0)const;
+/// Apply minimal image convention to n contiguous distance vectors, in place.
+  void apply(Vector*dlist, unsigned n)const;
+/// Computes d[i]=v2[i]-v1[i] for all i, using minimal image convention.
+/// d is resized if needed.
+  void distances(const std::vector<Vector>&v1,const std::vector<Vector>&v2,std::vector<Vector>&d)const;
+/// Computes d[i]=pos[pairs[i].second]-pos[pairs[i].first] for all i, using minimal image convention.
+/// d is resized if needed.
+  void distances(const std::vector<Vector>&pos,const std::vector<std::pair<unsigned,unsigned> >&pairs,std::vector<Vector>&d)const;
 /// Set the lattice vectors.
 /// b[i][j] is the j-th component of the i-th vector
   void setBox(const Tensor&b);
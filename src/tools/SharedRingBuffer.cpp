@@ -0,0 +1,288 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "SharedRingBuffer.h"
+#include "Exception.h"
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <ctime>
+
+#ifdef __PLUMED_HAS_SHM
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace PLMD{
+
+/// The head is written by the writer after the record is complete.
+/// Memory barriers make sure that readers never see the head
+/// before the content of the record.
+/// The generation (pid of the writer and creation time) identifies the segment,
+/// so that readers can notice when the writer has replaced it with a new one.
+/// The writer sets live when the segment is ready and clears it before removing it.
+struct SharedRingBuffer::Header{
+  unsigned long magic;
+  unsigned long pid;
+  unsigned long ctime;
+  unsigned long recordsize;
+  unsigned long capacity;
+  unsigned long offset;
+  volatile unsigned long live;
+  volatile unsigned long head;
+};
+
+namespace {
+const unsigned long shmMagic=0x504c4d44UL;
+
+inline void memoryBarrier(){
+#if defined(__GNUC__)
+  __sync_synchronize();
+#endif
+}
+}
+
+bool SharedRingBuffer::available(){
+#ifdef __PLUMED_HAS_SHM
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::string SharedRingBuffer::getNameForFile(const std::string& path){
+  std::string dir(".");
+  std::string file(path);
+  size_t slash=path.find_last_of('/');
+  if(slash!=std::string::npos){
+    dir=(slash==0?"/":path.substr(0,slash));
+    file=path.substr(slash+1);
+  }
+#ifdef __PLUMED_HAS_SHM
+  char resolved[PATH_MAX];
+  if(realpath(dir.c_str(),resolved)) dir=resolved;
+#endif
+  std::string full=dir+"/"+file;
+// segment names cannot contain slashes, so they are obtained from a hash (FNV-1a) of the path
+  unsigned long hash=2166136261UL;
+  for(unsigned i=0;i<full.length();i++){
+    hash^=static_cast<unsigned char>(full[i]);
+    hash=(hash*16777619UL)&0xffffffffUL;
+  }
+  char buffer[40];
+  std::sprintf(buffer,"/plumed-%08lx",hash);
+  return buffer;
+}
+
+SharedRingBuffer::SharedRingBuffer():
+  owner(false),
+  header(NULL),
+  records(NULL),
+  length(0),
+  pid(0),
+  ctime(0)
+{
+}
+
+SharedRingBuffer::~SharedRingBuffer(){
+  release();
+}
+
+void SharedRingBuffer::release(){
+#ifdef __PLUMED_HAS_SHM
+  if(header && owner){
+// tell the readers that this segment is not going to be updated any more
+    header->live=0;
+    memoryBarrier();
+  }
+  if(header) munmap(header,length);
+  if(owner) shm_unlink(name.c_str());
+#endif
+  header=NULL;
+  records=NULL;
+  length=0;
+  owner=false;
+}
+
+void SharedRingBuffer::create(const std::string& name,unsigned recordsize,unsigned long capacity,unsigned long offset){
+#ifdef __PLUMED_HAS_SHM
+  release();
+  plumed_assert(recordsize>0 && capacity>0);
+  this->name=name;
+// remove leftovers from previous runs, telling readers still attached to them
+// (e.g. after a crash of the previous writer) that they are not live any more
+  int oldfd=shm_open(name.c_str(),O_RDWR,0);
+  if(oldfd>=0){
+    struct stat st;
+    if(fstat(oldfd,&st)==0 && st.st_size>=static_cast<off_t>(sizeof(Header))){
+      void* old=mmap(NULL,sizeof(Header),PROT_READ|PROT_WRITE,MAP_SHARED,oldfd,0);
+      if(old!=MAP_FAILED){
+        static_cast<Header*>(old)->live=0;
+        memoryBarrier();
+        munmap(old,sizeof(Header));
+      }
+    }
+    close(oldfd);
+  }
+  shm_unlink(name.c_str());
+  int fd=shm_open(name.c_str(),O_CREAT|O_EXCL|O_RDWR,0600);
+  if(fd<0) plumed_merror("cannot create shared memory segment "+name);
+  length=sizeof(Header)+recordsize*capacity*sizeof(double);
+  if(ftruncate(fd,length)!=0){
+    close(fd);
+    shm_unlink(name.c_str());
+    plumed_merror("cannot allocate shared memory segment "+name);
+  }
+  void* ptr=mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+  close(fd);
+  if(ptr==MAP_FAILED){
+    shm_unlink(name.c_str());
+    plumed_merror("cannot map shared memory segment "+name);
+  }
+  owner=true;
+  header=static_cast<Header*>(ptr);
+  records=reinterpret_cast<double*>(header+1);
+  pid=static_cast<unsigned long>(getpid());
+  ctime=static_cast<unsigned long>(std::time(NULL));
+  header->pid=pid;
+  header->ctime=ctime;
+  header->recordsize=recordsize;
+  header->capacity=capacity;
+  header->offset=offset;
+  header->head=0;
+// readers only trust segments whose magic number has been set and that are marked live
+  memoryBarrier();
+  header->magic=shmMagic;
+  memoryBarrier();
+  header->live=1;
+#else
+  (void) name; (void) recordsize; (void) capacity; (void) offset;
+  plumed_merror("cannot use shared memory as plumed was compiled without it");
+#endif
+}
+
+bool SharedRingBuffer::attach(const std::string& name){
+#ifdef __PLUMED_HAS_SHM
+  release();
+  this->name=name;
+  int fd=shm_open(name.c_str(),O_RDONLY,0);
+  if(fd<0) return false;
+  struct stat st;
+  if(fstat(fd,&st)!=0 || st.st_size<static_cast<off_t>(sizeof(Header))){
+    close(fd);
+    return false;
+  }
+  void* ptr=mmap(NULL,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+  close(fd);
+  if(ptr==MAP_FAILED) return false;
+  Header* h=static_cast<Header*>(ptr);
+  bool ok=(h->live!=0 && h->magic==shmMagic);
+  memoryBarrier();
+  if(ok) ok=(st.st_size==static_cast<off_t>(sizeof(Header)+h->recordsize*h->capacity*sizeof(double)));
+  if(!ok){
+// the writer has not finished setting up the segment yet, or it is removing it
+    munmap(ptr,st.st_size);
+    return false;
+  }
+  header=h;
+  records=reinterpret_cast<double*>(header+1);
+  length=st.st_size;
+  pid=h->pid;
+  ctime=h->ctime;
+  return true;
+#else
+  (void) name;
+  plumed_merror("cannot use shared memory as plumed was compiled without it");
+  return false;
+#endif
+}
+
+bool SharedRingBuffer::isLive()const{
+  return header && header->live;
+}
+
+bool SharedRingBuffer::isCurrent()const{
+  if(!header) return false;
+  if(owner) return true;
+  if(!header->live) return false;
+#ifdef __PLUMED_HAS_SHM
+// the segment might have been replaced by a new writer after a crash, in which case
+// the name now points to a different segment
+  int fd=shm_open(name.c_str(),O_RDONLY,0);
+  if(fd<0) return false;
+  void* ptr=mmap(NULL,sizeof(Header),PROT_READ,MAP_SHARED,fd,0);
+  close(fd);
+  if(ptr==MAP_FAILED) return false;
+  const Header* h=static_cast<const Header*>(ptr);
+  bool same=(h->magic==shmMagic && h->pid==pid && h->ctime==ctime);
+  munmap(ptr,sizeof(Header));
+  return same;
+#else
+  return false;
+#endif
+}
+
+unsigned SharedRingBuffer::getRecordSize()const{
+  plumed_assert(header);
+  return header->recordsize;
+}
+
+unsigned long SharedRingBuffer::getHead()const{
+  plumed_assert(header);
+  return header->offset+header->head;
+}
+
+void SharedRingBuffer::push(const double* record){
+  plumed_assert(header && owner);
+  unsigned long k=header->head;
+  std::memcpy(records+(k%header->capacity)*header->recordsize,record,header->recordsize*sizeof(double));
+  memoryBarrier();
+  header->head=k+1;
+}
+
+unsigned long SharedRingBuffer::read(unsigned long first,std::vector<double>& buffer)const{
+  plumed_assert(header);
+  const unsigned long capacity=header->capacity;
+  const unsigned long recordsize=header->recordsize;
+  const unsigned long offset=header->offset;
+  while(true){
+    unsigned long head=header->head;
+    memoryBarrier();
+// the slot of the oldest record might be in the process of being overwritten
+    unsigned long oldest=(head>=capacity?head-capacity+1:0);
+    unsigned long k0=(first>offset?first-offset:0);
+    if(k0<oldest) k0=oldest;
+    if(k0>head) k0=head;
+    buffer.resize((head-k0)*recordsize);
+    for(unsigned long k=k0;k<head;k++){
+      std::memcpy(&buffer[(k-k0)*recordsize],records+(k%capacity)*recordsize,recordsize*sizeof(double));
+    }
+    memoryBarrier();
+// if the writer has started overwriting the first record while it was being copied, try again
+    if(header->head<k0+capacity) return offset+k0;
+  }
+}
+
+}
@@ -0,0 +1,109 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_SharedRingBuffer_h
+#define __PLUMED_tools_SharedRingBuffer_h
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace PLMD{
+
+/// \ingroup TOOLBOX
+/// A ring buffer of fixed-size records of doubles stored in POSIX shared memory.
+/// It has a single writer (the process that creates it) and any number of readers
+/// on the same host (the processes that attach to it). Records are identified by a
+/// serial number, which starts from the offset given at creation and is
+/// incremented by one at every push. When more than capacity records have
+/// been pushed, the oldest ones are overwritten (at most capacity-1 records
+/// can be read back); readers are told which records are no longer available
+/// so that they can get them in some other way.
+/// Only available if PLUMED has been compiled with __PLUMED_HAS_SHM.
+class SharedRingBuffer {
+private:
+/// Layout of the beginning of the shared segment
+  struct Header;
+/// Name of the shared memory segment
+  std::string name;
+/// True for the writer
+  bool owner;
+/// Address of the mapped segment
+  Header* header;
+/// Address of the first record
+  double* records;
+/// Size of the mapped segment
+  size_t length;
+/// Generation of the mapped segment: pid of the writer
+  unsigned long pid;
+/// Generation of the mapped segment: creation time
+  unsigned long ctime;
+/// Disallow copy
+  SharedRingBuffer(const SharedRingBuffer&);
+/// Disallow copy
+  SharedRingBuffer& operator=(const SharedRingBuffer&);
+/// Unmap the segment, and remove it if this is the writer
+  void release();
+public:
+/// Tells if shared memory is available in this build
+  static bool available();
+/// Get a name for the segment associated to a file.
+/// Paths pointing to the same file from different working directories
+/// give the same name.
+  static std::string getNameForFile(const std::string& path);
+  SharedRingBuffer();
+  ~SharedRingBuffer();
+/// Create a new segment for writing. An existing segment with the same name is removed.
+  void create(const std::string& name,unsigned recordsize,unsigned long capacity,unsigned long offset);
+/// Attach to a segment for reading. Returns false if the segment does not exist (yet)
+/// or if the writer has not marked it live.
+  bool attach(const std::string& name);
+/// Tells if a segment has been created or attached
+  bool isOpen()const;
+/// Tells if the writer has not released the attached segment yet.
+/// A new writer also clears this flag on the segment it replaces.
+/// This check does not require system calls, so it can be done at every read.
+  bool isLive()const;
+/// Tells if the attached segment is still the live one for its name.
+/// It returns false when the writer has released the segment or replaced it
+/// with a new one, in which case the reader should attach again.
+/// It opens the segment by name, so it should not be called too often.
+  bool isCurrent()const;
+/// Size of a record
+  unsigned getRecordSize()const;
+/// Serial number of the next record that will be pushed
+  unsigned long getHead()const;
+/// Append a record (writer only)
+  void push(const double*);
+/// Copy all the records from serial number first up to the last pushed one.
+/// Returns the serial number of the first record copied, which is larger than
+/// first if some of the requested records have already been overwritten.
+  unsigned long read(unsigned long first,std::vector<double>& buffer)const;
+};
+
+inline
+bool SharedRingBuffer::isOpen()const{
+  return header!=NULL;
+}
+
+}
+
+#endif
@@ -0,0 +1,949 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "XdrFile.h"
+#include "Exception.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+namespace PLMD{
+
+namespace {
+
+// The xtc compression algorithm is the one of the xdrfile library,
+// and the files written here are identical to those written by it.
+
+const int magicints[] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 10, 12, 16, 20, 25, 32, 40, 50, 64,
+  80, 101, 128, 161, 203, 256, 322, 406, 512, 645, 812, 1024, 1290,
+  1625, 2048, 2580, 3250, 4096, 5060, 6501, 8192, 10321, 13003,
+  16384, 20642, 26007, 32768, 41285, 52015, 65536, 82570, 104031,
+  131072, 165140, 208063, 262144, 330280, 416127, 524287, 660561,
+  832255, 1048576, 1321122, 1664510, 2097152, 2642245, 3329021,
+  4194304, 5284491, 6658042, 8388607, 10568983, 13316085, 16777216
+};
+
+const int firstidx=9;
+const int lastidx=sizeof(magicints)/sizeof(*magicints);
+const int maxabs=INT_MAX-2;
+const int xtcMagic=1995;
+const int trrMagic=1993;
+const char trrVersion[]="GMX_trn_file";
+
+/// Number of bits needed to store integers in [0,size)
+int sizeofint(int size){
+  unsigned num=1;
+  int nbits=0;
+  while(unsigned(size)>=num && nbits<32){ nbits++; num<<=1; }
+  return nbits;
+}
+
+/// Number of bits needed to store num integers in [0,sizes[i]) packed together
+int sizeofints(int num,const unsigned sizes[]){
+  unsigned bytes[32];
+  unsigned nbytes=1,nbits=0,bytecnt;
+  bytes[0]=1;
+  for(int i=0;i<num;i++){
+    unsigned tmp=0;
+    for(bytecnt=0;bytecnt<nbytes;bytecnt++){
+      tmp=bytes[bytecnt]*sizes[i]+tmp;
+      bytes[bytecnt]=tmp&0xff;
+      tmp>>=8;
+    }
+    while(tmp!=0){
+      bytes[bytecnt++]=tmp&0xff;
+      tmp>>=8;
+    }
+    nbytes=bytecnt;
+  }
+  unsigned n=1;
+  nbytes--;
+  while(bytes[nbytes]>=n){ nbits++; n*=2; }
+  return nbits+nbytes*8;
+}
+
+/// Bit stream written by the xtc compression
+class BitWriter {
+public:
+  std::vector<unsigned char> bytes;
+  int lastbits;
+  unsigned lastbyte;
+  BitWriter(): lastbits(0), lastbyte(0) {}
+  void sendbits(int nbits,int num){
+    while(nbits>=8){
+      lastbyte=(lastbyte<<8)|(num>>(nbits-8));
+      bytes.push_back((unsigned char)(lastbyte>>lastbits));
+      nbits-=8;
+    }
+    if(nbits>0){
+      lastbyte=(lastbyte<<nbits)|num;
+      lastbits+=nbits;
+      if(lastbits>=8){
+        lastbits-=8;
+        bytes.push_back((unsigned char)(lastbyte>>lastbits));
+      }
+    }
+  }
+  void sendints(int num,int nbits,const unsigned sizes[],const unsigned nums[]){
+    unsigned b[32],tmp=nums[0];
+    int nbytes=0,bytecnt;
+    do{
+      b[nbytes++]=tmp&0xff;
+      tmp>>=8;
+    } while(tmp!=0);
+    for(int i=1;i<num;i++){
+      tmp=nums[i];
+      for(bytecnt=0;bytecnt<nbytes;bytecnt++){
+        tmp=b[bytecnt]*sizes[i]+tmp;
+        b[bytecnt]=tmp&0xff;
+        tmp>>=8;
+      }
+      while(tmp!=0){
+        b[bytecnt++]=tmp&0xff;
+        tmp>>=8;
+      }
+      nbytes=bytecnt;
+    }
+    if(nbits>=nbytes*8){
+      for(int i=0;i<nbytes;i++) sendbits(8,b[i]);
+      sendbits(nbits-nbytes*8,0);
+    } else {
+      for(int i=0;i<nbytes-1;i++) sendbits(8,b[i]);
+      sendbits(nbits-(nbytes-1)*8,b[nbytes-1]);
+    }
+  }
+/// Write out the last incomplete byte
+  void finish(){
+    if(lastbits>0) bytes.push_back((unsigned char)(lastbyte<<(8-lastbits)));
+  }
+};
+
+/// Bit stream read by the xtc decompression
+class BitReader {
+  const unsigned char* data;
+  unsigned size;
+  unsigned cnt;
+  unsigned lastbits;
+  unsigned lastbyte;
+public:
+/// Set if the stream is read past its end
+  bool overflow;
+  BitReader(const unsigned char* data,unsigned size):
+    data(data), size(size), cnt(0), lastbits(0), lastbyte(0), overflow(false) {}
+  unsigned char nextByte(){
+    if(cnt>=size){ overflow=true; return 0; }
+    return data[cnt++];
+  }
+  int receivebits(int nbits){
+    int mask=(nbits<32?(1<<nbits)-1:-1);
+    int num=0;
+    while(nbits>=8){
+      lastbyte=(lastbyte<<8)|nextByte();
+      num|=(lastbyte>>lastbits)<<(nbits-8);
+      nbits-=8;
+    }
+    if(nbits>0){
+      if(int(lastbits)<nbits){
+        lastbits+=8;
+        lastbyte=(lastbyte<<8)|nextByte();
+      }
+      lastbits-=nbits;
+      num|=(lastbyte>>lastbits)&((1<<nbits)-1);
+    }
+    return num&mask;
+  }
+  void receiveints(int num,int nbits,const unsigned sizes[],int nums[]){
+    int b[32];
+    int nbytes=0;
+    b[1]=b[2]=b[3]=0;
+    while(nbits>8){
+      b[nbytes++]=receivebits(8);
+      nbits-=8;
+    }
+    if(nbits>0) b[nbytes++]=receivebits(nbits);
+    for(int i=num-1;i>0;i--){
+      int n=0;
+      for(int j=nbytes-1;j>=0;j--){
+        n=(n<<8)|b[j];
+        int p=n/sizes[i];
+        b[j]=p;
+        n=n-p*sizes[i];
+      }
+      nums[i]=n;
+    }
+    nums[0]=b[0]|(b[1]<<8)|(b[2]<<16)|(b[3]<<24);
+  }
+};
+
+/// Append XDR encoded data (big endian, padded to four bytes)
+void putInt(std::vector<unsigned char>& b,int i){
+  unsigned u=i;
+  b.push_back((unsigned char)(u>>24)); b.push_back((unsigned char)(u>>16));
+  b.push_back((unsigned char)(u>>8));  b.push_back((unsigned char)u);
+}
+
+void putFloat(std::vector<unsigned char>& b,float f){
+  int i; std::memcpy(&i,&f,4);
+  putInt(b,i);
+}
+
+void putOpaque(std::vector<unsigned char>& b,const std::vector<unsigned char>& data){
+  b.insert(b.end(),data.begin(),data.end());
+  while(b.size()%4) b.push_back(0);
+}
+
+/// Read XDR encoded data from a buffer
+class XdrInput {
+  const unsigned char* data;
+  unsigned size;
+  unsigned pos;
+public:
+/// Set if the buffer is read past its end
+  bool overflow;
+  XdrInput(const std::vector<unsigned char>& b):
+    data(b.size()>0?&b[0]:NULL), size(b.size()), pos(0), overflow(false) {}
+  int getInt(){
+    if(pos+4>size){ overflow=true; return 0; }
+    unsigned u=(unsigned(data[pos])<<24)|(unsigned(data[pos+1])<<16)|(unsigned(data[pos+2])<<8)|unsigned(data[pos+3]);
+    pos+=4;
+    return int(u);
+  }
+  float getFloat(){
+    int i=getInt(); float f; std::memcpy(&f,&i,4);
+    return f;
+  }
+  double getDouble(){
+    unsigned hi=getInt(),lo=getInt();
+    unsigned char b[8];
+    for(unsigned k=0;k<4;k++){ b[k]=(unsigned char)(hi>>(24-8*k)); b[4+k]=(unsigned char)(lo>>(24-8*k)); }
+// reassemble in the host byte order
+    double d; unsigned char h[8];
+    int one=1; bool little=(*(unsigned char*)&one==1);
+    for(unsigned k=0;k<8;k++) h[k]=(little?b[7-k]:b[k]);
+    std::memcpy(&d,h,8);
+    return d;
+  }
+  double getReal(bool dbl){
+    if(dbl) return getDouble();
+    return getFloat();
+  }
+/// Skip n bytes of opaque data, returning a pointer to them
+  const unsigned char* getOpaque(unsigned n){
+    unsigned padded=(n+3)&~3U;
+    if(pos+padded>size || pos+padded<pos){ overflow=true; return NULL; }
+    const unsigned char* p=data+pos;
+    pos+=padded;
+    return p;
+  }
+/// Skip an XDR string, that is its length followed by its characters padded to four bytes
+  void skipString(){
+    int n=getInt();
+    if(n<0) overflow=true;
+    if(overflow) return;
+    getOpaque(n);
+  }
+  unsigned getPosition()const{ return pos; }
+};
+
+/// Header of a trr frame
+class TrrHeader {
+public:
+  int ir_size,e_size,box_size,vir_size,pres_size,top_size,sym_size,x_size,v_size,f_size;
+  int natoms,step,nre;
+  bool dbl;
+  double time,lambda;
+/// Read the header, returns an error message or an empty string
+  std::string read(XdrInput& in){
+    if(in.getInt()!=trrMagic) return "wrong magic number in trr frame";
+// size of the version string including the terminator, followed by the string itself
+    if(in.getInt()<0) return "corrupted trr header";
+    in.skipString();
+    if(in.overflow) return "corrupted trr header";
+    int* fields[]={&ir_size,&e_size,&box_size,&vir_size,&pres_size,&top_size,&sym_size,&x_size,&v_size,&f_size,&natoms};
+    for(unsigned i=0;i<11;i++) *fields[i]=in.getInt();
+    if(in.overflow) return "truncated trr header";
+    for(unsigned i=0;i<11;i++) if(*fields[i]<0) return "corrupted trr header";
+    int fs;
+    if(box_size) fs=box_size/9;
+    else if(x_size && natoms>0) fs=x_size/(3*natoms);
+    else if(v_size && natoms>0) fs=v_size/(3*natoms);
+    else if(f_size && natoms>0) fs=f_size/(3*natoms);
+    else fs=sizeof(float);
+    if(fs!=sizeof(float) && fs!=sizeof(double)) return "cannot determine the precision of the trr file";
+    dbl=(fs==sizeof(double));
+    step=in.getInt();
+    nre=in.getInt();
+    time=in.getReal(dbl);
+    lambda=in.getReal(dbl);
+    if(in.overflow) return "truncated trr header";
+    return "";
+  }
+/// Size of the data that follows the header
+  long getBodySize()const{
+    return long(ir_size)+e_size+box_size+vir_size+pres_size+top_size+sym_size+x_size+v_size+f_size;
+  }
+};
+
+std::string decodeXtc(const std::vector<unsigned char>& buffer,XdrFrame& frame){
+  XdrInput in(buffer);
+  if(in.getInt()!=xtcMagic) return "wrong magic number in xtc frame";
+  frame.natoms=in.getInt();
+  frame.step=in.getInt();
+  frame.time=in.getFloat();
+  frame.lambda=0.0;
+  for(unsigned i=0;i<9;i++) frame.box[i]=in.getFloat();
+  int lsize=in.getInt();
+  if(in.overflow) return "truncated xtc frame";
+  if(lsize!=frame.natoms || lsize<0) return "inconsistent number of atoms in xtc frame";
+  frame.positions.resize(3*lsize);
+// small systems are not compressed
+  if(lsize<=9){
+    frame.precision=-1;
+    for(int i=0;i<3*lsize;i++) frame.positions[i]=in.getFloat();
+    if(in.overflow) return "truncated xtc frame";
+    return "";
+  }
+  frame.precision=in.getFloat();
+  int minint[3],maxint[3];
+  unsigned sizeint[3],sizesmall[3];
+  int bitsizeint[3]={0,0,0};
+  int bitsize;
+  for(unsigned i=0;i<3;i++) minint[i]=in.getInt();
+  for(unsigned i=0;i<3;i++) maxint[i]=in.getInt();
+  for(unsigned i=0;i<3;i++) sizeint[i]=maxint[i]-minint[i]+1;
+  if((sizeint[0]|sizeint[1]|sizeint[2])>0xffffff){
+    for(unsigned i=0;i<3;i++) bitsizeint[i]=sizeofint(sizeint[i]);
+    bitsize=0;
+  } else {
+    bitsize=sizeofints(3,sizeint);
+  }
+  int smallidx=in.getInt();
+  if(smallidx<firstidx || smallidx>=lastidx) return "corrupted xtc frame";
+  int smaller=magicints[std::max(firstidx,smallidx-1)]/2;
+  int smallnum=magicints[smallidx]/2;
+  sizesmall[0]=sizesmall[1]=sizesmall[2]=magicints[smallidx];
+  int nbytes=in.getInt();
+  if(nbytes<0) return "corrupted xtc frame";
+  const unsigned char* data=in.getOpaque(nbytes);
+  if(in.overflow) return "truncated xtc frame";
+
+  BitReader bits(data,nbytes);
+  float inv_precision=1.0/frame.precision;
+  float* lfp=(lsize>0?&frame.positions[0]:NULL);
+  int thiscoord[3],prevcoord[3];
+  int run=0,i=0;
+  while(i<lsize){
+    if(bitsize==0){
+      for(unsigned k=0;k<3;k++) thiscoord[k]=bits.receivebits(bitsizeint[k]);
+    } else {
+      bits.receiveints(3,bitsize,sizeint,thiscoord);
+    }
+    i++;
+    for(unsigned k=0;k<3;k++){ thiscoord[k]+=minint[k]; prevcoord[k]=thiscoord[k]; }
+    int flag=bits.receivebits(1);
+    int is_smaller=0;
+    if(flag==1){
+      run=bits.receivebits(5);
+      is_smaller=run%3;
+      run-=is_smaller;
+      is_smaller--;
+    }
+    if(i+run/3>lsize) return "corrupted xtc frame";
+    if(run>0){
+      for(int k=0;k<run;k+=3){
+        bits.receiveints(3,smallidx,sizesmall,thiscoord);
+        i++;
+        for(unsigned l=0;l<3;l++) thiscoord[l]+=prevcoord[l]-smallnum;
+        if(k==0){
+// the first two atoms were swapped for better compression of water molecules
+          for(unsigned l=0;l<3;l++){ int tmp=thiscoord[l]; thiscoord[l]=prevcoord[l]; prevcoord[l]=tmp; }
+          for(unsigned l=0;l<3;l++) *lfp++=prevcoord[l]*inv_precision;
+        } else {
+          for(unsigned l=0;l<3;l++) prevcoord[l]=thiscoord[l];
+        }
+        for(unsigned l=0;l<3;l++) *lfp++=thiscoord[l]*inv_precision;
+      }
+    } else {
+      for(unsigned l=0;l<3;l++) *lfp++=thiscoord[l]*inv_precision;
+    }
+    smallidx+=is_smaller;
+    if(smallidx<firstidx || smallidx>=lastidx) return "corrupted xtc frame";
+    if(is_smaller<0){
+      smallnum=smaller;
+      if(smallidx>firstidx) smaller=magicints[smallidx-1]/2;
+      else smaller=0;
+    } else if(is_smaller>0){
+      smaller=smallnum;
+      smallnum=magicints[smallidx]/2;
+    }
+    sizesmall[0]=sizesmall[1]=sizesmall[2]=magicints[smallidx];
+  }
+  if(bits.overflow) return "corrupted xtc frame";
+  return "";
+}
+
+std::string decodeTrr(const std::vector<unsigned char>& buffer,XdrFrame& frame){
+  XdrInput in(buffer);
+  TrrHeader h;
+  std::string err=h.read(in);
+  if(err.length()>0) return err;
+  frame.natoms=h.natoms;
+  frame.step=h.step;
+  frame.time=h.time;
+  frame.lambda=h.lambda;
+  frame.precision=-1;
+  for(unsigned i=0;i<9;i++) frame.box[i]=0.0;
+  if(h.box_size) for(unsigned i=0;i<9;i++) frame.box[i]=in.getReal(h.dbl);
+  if(h.vir_size) for(unsigned i=0;i<9;i++) in.getReal(h.dbl);
+  if(h.pres_size) for(unsigned i=0;i<9;i++) in.getReal(h.dbl);
+  frame.positions.assign(3*h.natoms,0.0);
+  if(h.x_size) for(int i=0;i<3*h.natoms;i++) frame.positions[i]=in.getReal(h.dbl);
+  if(in.overflow) return "truncated trr frame";
+  return "";
+}
+
+std::string encodeXtc(const XdrFrame& frame,std::vector<unsigned char>& out){
+  out.resize(0);
+  int size=frame.natoms;
+  putInt(out,xtcMagic);
+  putInt(out,size);
+  putInt(out,frame.step);
+  putFloat(out,frame.time);
+  for(unsigned i=0;i<9;i++) putFloat(out,frame.box[i]);
+  putInt(out,size);
+// small systems are not compressed
+  if(size<=9){
+    for(int i=0;i<3*size;i++) putFloat(out,frame.positions[i]);
+    return "";
+  }
+  float precision=frame.precision;
+  if(precision<=0) precision=1000;
+  putFloat(out,precision);
+
+  std::vector<int> ip(3*size);
+  int minint[3]={INT_MAX,INT_MAX,INT_MAX};
+  int maxint[3]={INT_MIN,INT_MIN,INT_MIN};
+  int mindiff=INT_MAX;
+  int old[3]={0,0,0};
+  for(int i=0;i<size;i++){
+    int lint[3];
+    for(unsigned k=0;k<3;k++){
+      float lf=frame.positions[3*i+k]*precision;
+      if(lf>=0.0) lf+=0.5;
+      else lf-=0.5;
+      if(std::fabs(lf)>maxabs) return "coordinates too large for xtc compression";
+      lint[k]=int(lf);
+      if(lint[k]<minint[k]) minint[k]=lint[k];
+      if(lint[k]>maxint[k]) maxint[k]=lint[k];
+      ip[3*i+k]=lint[k];
+    }
+    int diff=std::abs(old[0]-lint[0])+std::abs(old[1]-lint[1])+std::abs(old[2]-lint[2]);
+    if(diff<mindiff && i>0) mindiff=diff;
+    for(unsigned k=0;k<3;k++) old[k]=lint[k];
+  }
+  for(unsigned k=0;k<3;k++) putInt(out,minint[k]);
+  for(unsigned k=0;k<3;k++) putInt(out,maxint[k]);
+  for(unsigned k=0;k<3;k++) if(float(maxint[k])-float(minint[k])>=maxabs) return "coordinates too large for xtc compression";
+
+  unsigned sizeint[3],sizesmall[3];
+  int bitsizeint[3]={0,0,0};
+  int bitsize;
+  for(unsigned k=0;k<3;k++) sizeint[k]=maxint[k]-minint[k]+1;
+  if((sizeint[0]|sizeint[1]|sizeint[2])>0xffffff){
+    for(unsigned k=0;k<3;k++) bitsizeint[k]=sizeofint(sizeint[k]);
+    bitsize=0;
+  } else {
+    bitsize=sizeofints(3,sizeint);
+  }
+  int smallidx=firstidx;
+  while(smallidx<lastidx-1 && magicints[smallidx]<mindiff) smallidx++;
+  putInt(out,smallidx);
+// the index is only used to decide how to encode, so clamping it to the table does not change the format
+  int maxidx=std::min(lastidx-1,smallidx+8);
+  int minidx=maxidx-8;
+  int smaller=magicints[std::max(firstidx,smallidx-1)]/2;
+  int smallnum=magicints[smallidx]/2;
+  sizesmall[0]=sizesmall[1]=sizesmall[2]=magicints[smallidx];
+  int larger=magicints[maxidx]/2;
+
+  BitWriter bits;
+  unsigned tmpcoord[30];
+  int prevcoord[3]={0,0,0};
+  int prevrun=-1;
+  int i=0;
+  while(i<size){
+    int is_small=0,is_smaller;
+    int* thiscoord=&ip[3*i];
+    if(smallidx<maxidx && i>=1 &&
+       std::abs(thiscoord[0]-prevcoord[0])<larger &&
+       std::abs(thiscoord[1]-prevcoord[1])<larger &&
+       std::abs(thiscoord[2]-prevcoord[2])<larger){
+      is_smaller=1;
+    } else if(smallidx>minidx){
+      is_smaller=-1;
+    } else {
+      is_smaller=0;
+    }
+    if(i+1<size){
+      if(std::abs(thiscoord[0]-thiscoord[3])<smallnum &&
+         std::abs(thiscoord[1]-thiscoord[4])<smallnum &&
+         std::abs(thiscoord[2]-thiscoord[5])<smallnum){
+// swap the first with the second atom for better compression of water molecules
+        for(unsigned k=0;k<3;k++){ int tmp=thiscoord[k]; thiscoord[k]=thiscoord[3+k]; thiscoord[3+k]=tmp; }
+        is_small=1;
+      }
+    }
+    for(unsigned k=0;k<3;k++) tmpcoord[k]=thiscoord[k]-minint[k];
+    if(bitsize==0){
+      for(unsigned k=0;k<3;k++) bits.sendbits(bitsizeint[k],tmpcoord[k]);
+    } else {
+      bits.sendints(3,bitsize,sizeint,tmpcoord);
+    }
+    for(unsigned k=0;k<3;k++) prevcoord[k]=thiscoord[k];
+    thiscoord+=3;
+    i++;
+
+    int run=0;
+    if(is_small==0 && is_smaller==-1) is_smaller=0;
+    while(is_small && run<8*3){
+      if(is_smaller==-1 && (
+           (thiscoord[0]-prevcoord[0])*(thiscoord[0]-prevcoord[0])+
+           (thiscoord[1]-prevcoord[1])*(thiscoord[1]-prevcoord[1])+
+           (thiscoord[2]-prevcoord[2])*(thiscoord[2]-prevcoord[2])>=smaller*smaller)){
+        is_smaller=0;
+      }
+      for(unsigned k=0;k<3;k++) tmpcoord[run++]=thiscoord[k]-prevcoord[k]+smallnum;
+      for(unsigned k=0;k<3;k++) prevcoord[k]=thiscoord[k];
+      i++;
+      thiscoord+=3;
+      is_small=0;
+      if(i<size &&
+         std::abs(thiscoord[0]-prevcoord[0])<smallnum &&
+         std::abs(thiscoord[1]-prevcoord[1])<smallnum &&
+         std::abs(thiscoord[2]-prevcoord[2])<smallnum){
+        is_small=1;
+      }
+    }
+    if(run!=prevrun || is_smaller!=0){
+      prevrun=run;
+      bits.sendbits(1,1);
+      bits.sendbits(5,run+is_smaller+1);
+    } else {
+      bits.sendbits(1,0);
+    }
+    for(int k=0;k<run;k+=3) bits.sendints(3,smallidx,sizesmall,&tmpcoord[k]);
+    if(is_smaller!=0){
+      smallidx+=is_smaller;
+      if(is_smaller<0){
+        smallnum=smaller;
+        if(smallidx>firstidx) smaller=magicints[smallidx-1]/2;
+        else smaller=0;
+      } else if(is_smaller>0){
+        smaller=smallnum;
+        smallnum=magicints[smallidx]/2;
+      }
+      sizesmall[0]=sizesmall[1]=sizesmall[2]=magicints[smallidx];
+    }
+  }
+  bits.finish();
+  putInt(out,bits.bytes.size());
+  putOpaque(out,bits.bytes);
+  return "";
+}
+
+std::string encodeTrr(const XdrFrame& frame,std::vector<unsigned char>& out){
+  out.resize(0);
+  putInt(out,trrMagic);
+  putInt(out,std::strlen(trrVersion)+1);
+  putInt(out,std::strlen(trrVersion));
+  std::vector<unsigned char> version(trrVersion,trrVersion+std::strlen(trrVersion));
+  putOpaque(out,version);
+// ir, e, box, vir, pres, top, sym, x, v, f sizes
+  int sizes[]={0,0,int(9*sizeof(float)),0,0,0,0,int(3*frame.natoms*sizeof(float)),0,0};
+  for(unsigned i=0;i<10;i++) putInt(out,sizes[i]);
+  putInt(out,frame.natoms);
+  putInt(out,frame.step);
+  putInt(out,0);
+  putFloat(out,frame.time);
+  putFloat(out,frame.lambda);
+  for(unsigned i=0;i<9;i++) putFloat(out,frame.box[i]);
+  for(int i=0;i<3*frame.natoms;i++) putFloat(out,frame.positions[i]);
+  return "";
+}
+
+}
+
+XdrFrame::XdrFrame():
+  natoms(0),
+  step(0),
+  time(0.0),
+  lambda(0.0),
+  precision(1000.0)
+{
+  for(unsigned i=0;i<9;i++) box[i]=0.0;
+}
+
+class XdrReader::Slot {
+public:
+  XdrFrame frame;
+  std::string error;
+  unsigned index;
+  bool ready;
+  Slot(): index(0), ready(false) {}
+};
+
+XdrReader::XdrReader():
+  fp(NULL),
+  trr(false),
+  natoms(0),
+  nextToRead(0),
+  nextToDecode(0),
+  nthreads(0),
+  stop(false)
+{
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_mutex_init(&mutex,NULL);
+  pthread_cond_init(&cond,NULL);
+#endif
+}
+
+XdrReader::~XdrReader(){
+  close();
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+#endif
+}
+
+void XdrReader::lock(){
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_mutex_lock(&mutex);
+#endif
+}
+
+void XdrReader::unlock(){
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_mutex_unlock(&mutex);
+#endif
+}
+
+bool XdrReader::open(const std::string& path){
+  close();
+  fp=std::fopen(path.c_str(),"rb");
+  if(!fp) return false;
+  this->path=path;
+  std::vector<unsigned char> buffer(4);
+  if(std::fread(&buffer[0],1,4,fp)!=4) plumed_merror("file "+path+" is empty");
+  XdrInput in(buffer);
+  int magic=in.getInt();
+  if(magic==xtcMagic) trr=false;
+  else if(magic==trrMagic) trr=true;
+  else plumed_merror("file "+path+" is neither in xtc nor in trr format");
+  buildIndex();
+  if(offsets.size()==0) plumed_merror("file "+path+" does not contain any complete frame");
+  XdrFrame frame;
+  readFrame(0,frame);
+  natoms=frame.natoms;
+  return true;
+}
+
+void XdrReader::buildIndex(){
+  std::fseek(fp,0,SEEK_END);
+  long filesize=std::ftell(fp);
+  long offset=0;
+  std::vector<unsigned char> buffer;
+  while(offset<filesize){
+    long size;
+    std::fseek(fp,offset,SEEK_SET);
+    if(!trr){
+// magic, natoms, step, time, box and natoms again
+      buffer.resize(92);
+      unsigned n=std::fread(&buffer[0],1,92,fp);
+      if(n<56) break;
+      XdrInput in(buffer);
+      if(in.getInt()!=xtcMagic) break;
+      int nat=in.getInt();
+      if(nat<0) break;
+      if(nat<=9) size=56+12*long(nat);
+      else {
+        if(n<92) break;
+// step, time, box, natoms, precision, minint, maxint and smallidx come before the number of bytes
+        for(unsigned i=0;i<20;i++) in.getInt();
+        int nbytes=in.getInt();
+        if(nbytes<0) break;
+        size=92+((long(nbytes)+3)&~3L);
+      }
+    } else {
+// the version string is short, so that this always contains the full header
+      buffer.resize(256);
+      unsigned n=std::fread(&buffer[0],1,256,fp);
+      buffer.resize(n);
+      XdrInput in(buffer);
+      TrrHeader h;
+      std::string err=h.read(in);
+// a truncated header is the end of an incomplete file, anything else is an error
+      if(err.length()>0 && in.overflow) break;
+      if(err.length()>0) plumed_merror("file "+path+": "+err);
+      size=in.getPosition()+h.getBodySize();
+    }
+    if(size<=0 || offset+size>filesize) break;
+    offsets.push_back(offset);
+    sizes.push_back(size);
+    offset+=size;
+  }
+}
+
+void XdrReader::readRaw(unsigned i,std::vector<unsigned char>& buffer){
+  buffer.resize(sizes[i]);
+  std::fseek(fp,offsets[i],SEEK_SET);
+  if(std::fread(&buffer[0],1,sizes[i],fp)!=unsigned(sizes[i])) buffer.resize(0);
+}
+
+std::string XdrReader::decode(const std::vector<unsigned char>& buffer,XdrFrame& frame)const{
+  if(buffer.size()==0) return "error reading file "+path;
+  if(trr) return decodeTrr(buffer,frame);
+  return decodeXtc(buffer,frame);
+}
+
+void XdrReader::close(){
+  stopThreads();
+  if(fp) std::fclose(fp);
+  fp=NULL;
+  offsets.clear();
+  sizes.clear();
+  nextToRead=nextToDecode=0;
+  natoms=0;
+}
+
+int XdrReader::getNumberOfAtoms()const{
+  return natoms;
+}
+
+unsigned XdrReader::getNumberOfFrames()const{
+  return offsets.size();
+}
+
+void XdrReader::setNumberOfThreads(unsigned n){
+  plumed_massert(slots.size()==0,"number of threads cannot be changed while frames are being read");
+#ifdef __PLUMED_HAS_PTHREAD
+  nthreads=n;
+#endif
+}
+
+void XdrReader::readFrame(unsigned i,XdrFrame& frame){
+  plumed_massert(i<offsets.size(),"frame index out of range");
+  std::vector<unsigned char> buffer;
+  lock();
+  readRaw(i,buffer);
+  unlock();
+  std::string err=decode(buffer,frame);
+  if(err.length()>0) plumed_merror("file "+path+": "+err);
+}
+
+bool XdrReader::next(XdrFrame& frame){
+  if(nextToRead>=offsets.size()) return false;
+  if(nthreads==0){
+    readFrame(nextToRead++,frame);
+    return true;
+  }
+  if(slots.size()==0) startThreads();
+// if no thread could be started frames are decoded here
+  if(slots.size()==0){
+    readFrame(nextToRead++,frame);
+    return true;
+  }
+#ifdef __PLUMED_HAS_PTHREAD
+  Slot* s=slots[nextToRead%slots.size()];
+  lock();
+  while(!(s->ready && s->index==nextToRead)) pthread_cond_wait(&cond,&mutex);
+// positions are swapped so that the slot reuses the memory of the caller
+  std::vector<float> tmp;
+  tmp.swap(s->frame.positions);
+  frame=s->frame;
+  frame.positions.swap(tmp);
+  s->frame.positions.swap(tmp);
+  std::string err=s->error;
+  s->ready=false;
+  nextToRead++;
+  pthread_cond_broadcast(&cond);
+  unlock();
+  if(err.length()>0) plumed_merror("file "+path+": "+err);
+#endif
+  return true;
+}
+
+void XdrReader::startThreads(){
+#ifdef __PLUMED_HAS_PTHREAD
+  stop=false;
+  nextToDecode=nextToRead;
+// a few frames per thread are enough to keep all of them busy
+  slots.resize(4*nthreads);
+  for(unsigned i=0;i<slots.size();i++) slots[i]=new Slot;
+  for(unsigned i=0;i<nthreads;i++){
+    pthread_t t;
+    if(pthread_create(&t,NULL,&XdrReader::run,this)==0) threads.push_back(t);
+  }
+  if(threads.size()==0){
+// no thread available, decode frames when they are requested
+    for(unsigned i=0;i<slots.size();i++) delete slots[i];
+    slots.clear();
+    nthreads=0;
+  }
+#endif
+}
+
+void XdrReader::stopThreads(){
+#ifdef __PLUMED_HAS_PTHREAD
+  lock();
+  stop=true;
+  pthread_cond_broadcast(&cond);
+  unlock();
+  for(unsigned i=0;i<threads.size();i++) pthread_join(threads[i],NULL);
+  threads.clear();
+#endif
+  for(unsigned i=0;i<slots.size();i++) delete slots[i];
+  slots.clear();
+}
+
+void* XdrReader::run(void*ptr){
+  static_cast<XdrReader*>(ptr)->work();
+  return NULL;
+}
+
+void XdrReader::work(){
+#ifdef __PLUMED_HAS_PTHREAD
+  std::vector<unsigned char> buffer;
+  while(true){
+    lock();
+    while(!stop && (nextToDecode>=offsets.size() || nextToDecode>=nextToRead+slots.size())) pthread_cond_wait(&cond,&mutex);
+    if(stop){
+      unlock();
+      return;
+    }
+    unsigned i=nextToDecode++;
+    Slot* s=slots[i%slots.size()];
+// the file is shared, only decoding is done in parallel
+    readRaw(i,buffer);
+    unlock();
+    std::string err;
+// exceptions cannot cross the thread boundary, they are reported by next()
+    try{
+      err=decode(buffer,s->frame);
+    } catch(std::exception& e){
+      err=e.what();
+    } catch(...){
+      err="unknown error while decoding";
+    }
+    lock();
+    s->error=err;
+    s->index=i;
+    s->ready=true;
+    pthread_cond_broadcast(&cond);
+    unlock();
+  }
+#endif
+}
+
+XdrWriter::XdrWriter():
+  fp(NULL),
+  trr(false),
+  busy(false)
+{
+}
+
+XdrWriter::~XdrWriter(){
+#ifdef __PLUMED_HAS_PTHREAD
+// errors cannot be reported from here
+  if(busy) pthread_join(thread,NULL);
+#endif
+  busy=false;
+  if(fp) std::fclose(fp);
+}
+
+void XdrWriter::open(const std::string& path,const std::string& type,const std::string& mode){
+  close();
+  if(type=="xtc") trr=false;
+  else if(type=="trr") trr=true;
+  else plumed_merror("unknown xdr file type "+type);
+  fp=std::fopen(path.c_str(),mode.c_str());
+  if(!fp) plumed_merror("cannot open file "+path);
+  this->path=path;
+}
+
+void XdrWriter::close(){
+  wait();
+  if(fp) std::fclose(fp);
+  fp=NULL;
+}
+
+void XdrWriter::write(){
+  if(trr) error=encodeTrr(frame,buffer);
+  else error=encodeXtc(frame,buffer);
+  if(error.length()>0) return;
+  if(std::fwrite(&buffer[0],1,buffer.size(),fp)!=buffer.size()) error="error writing file "+path;
+}
+
+void* XdrWriter::run(void*ptr){
+  XdrWriter* writer=static_cast<XdrWriter*>(ptr);
+// exceptions cannot cross the thread boundary, they are reported by wait()
+  try{
+    writer->write();
+  } catch(std::exception& e){
+    writer->error=e.what();
+  } catch(...){
+    writer->error="unknown error while writing "+writer->path;
+  }
+  return NULL;
+}
+
+void XdrWriter::write(const XdrFrame& f){
+  plumed_massert(fp,"file should be opened before writing");
+  plumed_massert(int(f.positions.size())==3*f.natoms,"wrong number of positions in frame");
+  wait();
+  frame=f;
+#ifdef __PLUMED_HAS_PTHREAD
+  if(pthread_create(&thread,NULL,&XdrWriter::run,this)==0){
+    busy=true;
+    return;
+  }
+#endif
+// no thread available, write now
+  write();
+  wait();
+}
+
+void XdrWriter::wait(){
+#ifdef __PLUMED_HAS_PTHREAD
+  if(busy) pthread_join(thread,NULL);
+#endif
+  busy=false;
+  if(error.length()>0){
+    std::string msg=error;
+    error="";
+    plumed_merror("file "+path+": "+msg);
+  }
+}
+
+}
@@ -0,0 +1,157 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2014 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed-code.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_XdrFile_h
+#define __PLUMED_tools_XdrFile_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef __PLUMED_HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace PLMD{
+
+/// \ingroup TOOLBOX
+/// A single frame of a GROMACS xtc or trr trajectory.
+/// Lengths are in nm and the box is stored row by row, one lattice vector per row.
+class XdrFrame {
+public:
+  int natoms;
+  int step;
+  float time;
+  float lambda;
+/// Precision of the xtc compression, e.g. 1000 for three digits
+  float precision;
+  float box[9];
+/// Positions stored as x1,y1,z1,x2,...
+  std::vector<float> positions;
+  XdrFrame();
+};
+
+/// \ingroup TOOLBOX
+/// Reads GROMACS xtc and trr trajectories without the xdrfile library.
+/// When a file is opened the offsets of all its frames are collected,
+/// so that any frame can be read with readFrame().
+/// Frames can also be read in order with next(). If threads are requested
+/// with setNumberOfThreads() the frames that follow the one being returned
+/// are decoded in the background and kept in a queue.
+/// A truncated frame at the end of the file is ignored.
+class XdrReader {
+private:
+  class Slot;
+  std::FILE* fp;
+  std::string path;
+/// True if the file is in trr format
+  bool trr;
+  int natoms;
+/// Position and size of each frame in the file
+  std::vector<long> offsets;
+  std::vector<long> sizes;
+/// Index of the frame that will be returned by next()
+  unsigned nextToRead;
+/// Index of the next frame to be given to a decoding thread
+  unsigned nextToDecode;
+  unsigned nthreads;
+/// Decoded frames, frame i being in slot i%slots.size()
+  std::vector<Slot*> slots;
+  bool stop;
+#ifdef __PLUMED_HAS_PTHREAD
+  std::vector<pthread_t> threads;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif
+/// Build the list of frames
+  void buildIndex();
+/// Read the raw bytes of a frame
+  void readRaw(unsigned i,std::vector<unsigned char>& buffer);
+/// Decode a frame. Returns an error message or an empty string
+  std::string decode(const std::vector<unsigned char>& buffer,XdrFrame& frame)const;
+  void startThreads();
+  void stopThreads();
+/// Loop run by each decoding thread
+  void work();
+  static void* run(void*);
+  void lock();
+  void unlock();
+  XdrReader(const XdrReader&);
+  XdrReader& operator=(const XdrReader&);
+public:
+  XdrReader();
+  ~XdrReader();
+/// Open a file, the format is detected from its content. Returns false if the file cannot be opened
+  bool open(const std::string& path);
+  void close();
+/// Number of atoms in the first frame
+  int getNumberOfAtoms()const;
+  unsigned getNumberOfFrames()const;
+/// Number of threads decoding frames ahead of next(), zero to decode them when they are requested
+  void setNumberOfThreads(unsigned n);
+/// Read frame i
+  void readFrame(unsigned i,XdrFrame& frame);
+/// Read the next frame, returns false at the end of the file
+  bool next(XdrFrame& frame);
+};
+
+/// \ingroup TOOLBOX
+/// Writes GROMACS xtc and trr trajectories without the xdrfile library.
+/// Each frame is copied and then compressed and written by a background thread,
+/// so that the caller can continue while this is done.
+/// A new frame first waits for the previous one to be written.
+/// Without pthread support frames are written immediately.
+class XdrWriter {
+private:
+  std::FILE* fp;
+  std::string path;
+  bool trr;
+/// The frame being written
+  XdrFrame frame;
+/// Encoded frame
+  std::vector<unsigned char> buffer;
+/// True if a background write is in progress
+  bool busy;
+/// Error raised by the last write, reported on the next call to wait()
+  std::string error;
+#ifdef __PLUMED_HAS_PTHREAD
+  pthread_t thread;
+#endif
+  void write();
+  static void* run(void*);
+  XdrWriter(const XdrWriter&);
+  XdrWriter& operator=(const XdrWriter&);
+public:
+  XdrWriter();
+/// Waits for the last frame to be written and closes the file
+  ~XdrWriter();
+/// Open a file. Type should be xtc or trr, mode is passed to fopen
+  void open(const std::string& path,const std::string& type,const std::string& mode);
+  void close();
+/// Start writing a frame
+  void write(const XdrFrame&);
+/// Wait for the last frame to be written
+  void wait();
+};
+
+}
+
+#endif
@@ -87,7 +87,6 @@ COM::COM(const ActionOptions&ao):
 void COM::calculate(){
   Vector pos;
   double mass(0.0);
-  vector<Tensor> deriv(getNumberOfAtoms());
   for(unsigned i=0;i<getNumberOfAtoms();i++) mass+=getMass(i);
   if( plumed.getAtoms().chargesWereSet() ){
      double charge(0.0);
@@ -98,11 +97,10 @@ void COM::calculate(){
   }
   for(unsigned i=0;i<getNumberOfAtoms();i++){
     pos+=(getMass(i)/mass)*getPosition(i);
-    deriv[i]=(getMass(i)/mass)*Tensor::identity();
+    setAtomWeight(i,getMass(i)/mass);
   }
   setPosition(pos);
   setMass(mass);
-  setAtomsDerivatives(deriv);
 }
 
 }
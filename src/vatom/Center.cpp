@@ -113,7 +113,6 @@ Center::Center(const ActionOptions&ao):
 void Center::calculate(){
   Vector pos;
   double mass(0.0);
-  vector<Tensor> deriv(getNumberOfAtoms());
   for(unsigned i=0;i<getNumberOfAtoms();i++) mass+=getMass(i);
   if( plumed.getAtoms().chargesWereSet() ){
      double charge(0.0);
@@ -129,11 +128,10 @@ void Center::calculate(){
     if(weight_mass) w=getMass(i)/mass;
     else w=weights[i]/wtot;
     pos+=w*getPosition(i);
-    deriv[i]=w*Tensor::identity();
+    setAtomWeight(i,w);
   }
   setPosition(pos);
   setMass(mass);
-  setAtomsDerivatives(deriv);
 }
 
 }
@@ -66,6 +66,8 @@ public:
   void completeNumericalDerivatives();
 /// This is used to tell if the bridge has been called in recompute
   bool prerequisitsCalculated();
+/// Get the action we are outputting to
+  ActionWithVessel* getOutputAction();
 };
 
 inline
@@ -73,6 +75,11 @@ bool BridgeVessel::prerequisitsCalculated(){
   return in_normal_calculate;
 }
 
+inline
+ActionWithVessel* BridgeVessel::getOutputAction(){
+  return myOutputAction;
+}
+
 }
 }
 #endif